@@ -0,0 +1,69 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//
+// Times building an AutoMPO for an all-to-all two-body
+// Hamiltonian of N spinless fermions,
+//
+//   H = sum_{i!=j} t_ij Cdag_i C_j + sum_{i<j} V_ij N_i N_j
+//
+// with every hopping term also entered a second time
+// (as happens when a Hamiltonian is written out from
+// integrals with both index orders) so that half of
+// the additions merge into existing terms, then the
+// conversion to an MPO with toMPO.
+//
+// Usage: autompo_bench [N] [nthread]
+//
+#include <chrono>
+#include <cstdlib>
+#include "itensor/all.h"
+#include "itensor/util/threadpool.h"
+
+using namespace itensor;
+
+int
+main(int argc, char* argv[])
+    {
+    int N = 100,
+        nthread = 4;
+    if(argc > 1) N = std::atoi(argv[1]);
+    if(argc > 2) nthread = std::atoi(argv[2]);
+    setNThread(nthread);
+
+    auto sites = Fermion(N,{"ConserveQNs=",true});
+    auto t = [](int i, int j) { return -1./(1.+std::abs(i-j)) + 0.01*((i*7+j*13)%17); };
+
+    auto start = std::chrono::steady_clock::now();
+    auto ampo = AutoMPO(sites);
+    for(auto i : range1(N))
+    for(auto j : range1(N))
+        {
+        if(i == j) continue;
+        ampo += 0.5*t(i,j),"Cdag",i,"C",j;
+        ampo += 0.5*t(j,i),"Cdag",i,"C",j;
+        if(i < j) ampo += 1./std::abs(i-j),"N",i,"N",j;
+        }
+    auto built = std::chrono::steady_clock::now();
+    auto H = toMPO(ampo);
+    auto end = std::chrono::steady_clock::now();
+
+    auto secs = [](decltype(start) a, decltype(start) b) { return std::chrono::duration<double>(b-a).count(); };
+    printfln("N = %d, %d terms, %d thread(s)",N,ampo.size(),getNThread());
+    printfln("AutoMPO  %8.3f s",secs(start,built));
+    printfln("toMPO    %8.3f s (max bond dimension %d)",secs(built,end),maxLinkDim(H));
+
+    return 0;
+    }
@@ -0,0 +1,107 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//
+// Compares the two dense contraction methods,
+// permute+gemm (ContractMethod::Permute) and
+// panel packing (ContractMethod::Packed),
+// on contractions shaped like the ones done by
+// LocalOp::product in DMRG: environment (rank 3)
+// times wavefunction (rank 4) times MPO (rank 4).
+//
+// Usage: contract_bench [m] [nrepeat]
+//   m: bond dimension (default 200)
+//
+#include <chrono>
+#include <cstdlib>
+#include "itensor/tensor/contract.h"
+#include "itensor/global.h"
+
+using namespace itensor;
+
+double
+timeContract(ContractMethod method,
+             Tensor const& A, Labels const& ai,
+             Tensor const& B, Labels const& bi,
+             Tensor & C, Labels const& ci,
+             int nrepeat)
+    {
+    //Warm up, e.g. the contraction plan cache
+    contract(makeRef(A),ai,makeRef(B),bi,makeRef(C),ci,1.,0.,method);
+    auto start = std::chrono::steady_clock::now();
+    for(int n = 0; n < nrepeat; ++n)
+        {
+        contract(makeRef(A),ai,makeRef(B),bi,makeRef(C),ci,1.,0.,method);
+        }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end-start).count()/nrepeat;
+    }
+
+void
+runCase(std::string const& name,
+        Tensor const& A, Labels const& ai,
+        Tensor const& B, Labels const& bi,
+        Tensor & C, Labels const& ci,
+        int nrepeat)
+    {
+    auto C2 = C;
+    auto tperm = timeContract(ContractMethod::Permute,A,ai,B,bi,C,ci,nrepeat);
+    auto tpack = timeContract(ContractMethod::Packed,A,ai,B,bi,C2,ci,nrepeat);
+    Real diff = 0;
+    for(auto n : range(C.size())) diff = std::max(diff,std::fabs(C.store()[n]-C2.store()[n]));
+    printfln("%-28s permute %10.5f s   packed %10.5f s   speedup %5.2f   max diff %.2E",
+             name,tperm,tpack,tperm/tpack,diff);
+    }
+
+void
+randomize(Tensor & T)
+    {
+    for(auto& el : T) el = Global::random();
+    }
+
+int
+main(int argc, char* argv[])
+    {
+    long m = 200;
+    int nrepeat = 5;
+    if(argc > 1) m = std::atol(argv[1]);
+    if(argc > 2) nrepeat = std::atoi(argv[2]);
+    long d = 2,  //site dimension
+         k = 5;  //MPO bond dimension
+
+    printfln("Bond dimension m = %d, site dimension d = %d, MPO dimension k = %d\n",m,d,k);
+
+    //L(a,w,a') psi(a,s1,s2,b) -> T(w,a',s1,s2,b)
+    auto L = Tensor(m,k,m),
+         psi = Tensor(m,d,d,m),
+         T1 = Tensor(k,m,d,d,m);
+    randomize(L);
+    randomize(psi);
+    runCase("L*psi",L,{1,2,3},psi,{1,4,5,6},T1,{2,3,4,5,6},nrepeat);
+
+    //T(w,a',s1,s2,b) W(w,s1,s1',w') -> U(a',s1',w',s2,b)
+    auto W = Tensor(k,d,d,k),
+         U = Tensor(m,d,k,d,m);
+    randomize(W);
+    runCase("(L*psi)*W",T1,{2,3,4,5,6},W,{2,4,7,8},U,{3,7,8,5,6},nrepeat);
+
+    //U(a',s1',w',s2,b) R(b,w',b') -> V(a',s1',s2,b')
+    auto R = Tensor(m,k,m),
+         V = Tensor(m,d,d,m);
+    randomize(R);
+    runCase("(L*psi*W)*R",U,{3,7,8,5,6},R,{6,8,9},V,{3,7,5,9},nrepeat);
+
+    return 0;
+    }
@@ -0,0 +1,103 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//
+// Compares the SVD methods (SVDMethod::Recursive,
+// Gesdd, Gesvd) on square and rectangular blocks,
+// with both a flat and a quickly decaying spectrum
+// (the latter is typical of DMRG wavefunctions and
+// makes the recursive method do extra passes).
+//
+// Usage: svd_bench [nrepeat]
+//
+#include <chrono>
+#include <cstdlib>
+#include "itensor/tensor/algs.h"
+#include "itensor/global.h"
+
+using namespace itensor;
+
+template<typename T>
+double
+timeSVD(Mat<T> const& M,
+        SVDMethod method,
+        int nrepeat,
+        Real & err)
+    {
+    Mat<T> U,V;
+    Vector d;
+    auto start = std::chrono::steady_clock::now();
+    for(int n = 0; n < nrepeat; ++n)
+        {
+        SVD(M,U,d,V,SVD_THRESH,method);
+        }
+    auto end = std::chrono::steady_clock::now();
+    auto D = Matrix(d.size(),d.size());
+    diagonal(D) &= d;
+    err = norm(M-U*D*conj(transpose(V)))/norm(M);
+    return std::chrono::duration<double>(end-start).count()/nrepeat;
+    }
+
+template<typename T>
+void
+runCase(Mat<T> const& M,
+        std::string const& spectrum,
+        int nrepeat)
+    {
+    printf("%4d x %-4d %-5s %-8s",int(nrows(M)),int(ncols(M)),isCplx(M) ? "cplx" : "real",spectrum.c_str());
+    for(auto method : {SVDMethod::Recursive,SVDMethod::Gesdd,SVDMethod::Gesvd})
+        {
+        Real err = 0;
+        auto t = timeSVD(M,method,nrepeat,err);
+        printf("  %9.5f s (err %.1E)",t,err);
+        }
+    printf("\n");
+    }
+
+template<typename T>
+Mat<T>
+testMatrix(long nr, long nc, bool decaying)
+    {
+    auto M = Mat<T>(nr,nc);
+    for(auto& el : M) el = Global::random();
+    if(!decaying) return M;
+    //Replace singular values by 0.7^j
+    Mat<T> U,V;
+    Vector d;
+    SVD(M,U,d,V);
+    auto D = Matrix(d.size(),d.size());
+    for(auto j : range(d.size())) D(j,j) = std::pow(0.7,j);
+    return U*D*conj(transpose(V));
+    }
+
+int
+main(int argc, char* argv[])
+    {
+    int nrepeat = 3;
+    if(argc > 1) nrepeat = std::atoi(argv[1]);
+
+    printfln("%-25s %-26s %-26s %-26s","block","recursive","gesdd","gesvd");
+    auto shapes = std::vector<std::pair<long,long>>{{50,50},{200,200},{400,400},{100,400},{400,100},{800,200}};
+    for(auto& s : shapes)
+    for(auto decaying : {false,true})
+        {
+        runCase(testMatrix<Real>(s.first,s.second,decaying),decaying ? "decay" : "flat",nrepeat);
+        }
+    for(auto decaying : {false,true})
+        {
+        runCase(testMatrix<Cplx>(200,200,decaying),decaying ? "decay" : "flat",nrepeat);
+        }
+    return 0;
+    }
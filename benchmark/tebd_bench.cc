@@ -0,0 +1,80 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//
+// Times real-time evolution of a Heisenberg chain with
+// a brickwork (odd bonds, then even bonds) gate list using
+// gateTEvol's "Sequential" and "Parallel" methods, and
+// reports the overlap of the two final states.
+//
+// Usage: tebd_bench [N] [maxdim] [nthread]
+//
+#include <chrono>
+#include <cstdlib>
+#include "itensor/all.h"
+#include "itensor/util/threadpool.h"
+
+using namespace itensor;
+
+int
+main(int argc, char* argv[])
+    {
+    int N = 40,
+        maxdim = 128,
+        nthread = 4;
+    if(argc > 1) N = std::atoi(argv[1]);
+    if(argc > 2) maxdim = std::atoi(argv[2]);
+    if(argc > 3) nthread = std::atoi(argv[3]);
+    setNThread(nthread);
+
+    auto sites = SpinHalf(N,{"ConserveQNs=",true});
+    auto tau = 0.05,
+         ttotal = 1.;
+    auto gates = std::vector<BondGate>{};
+    for(int start : {1,2})
+    for(int b = start; b < N; b += 2)
+        {
+        auto hh = sites.op("Sz",b)*sites.op("Sz",b+1);
+        hh += 0.5*sites.op("S+",b)*sites.op("S-",b+1);
+        hh += 0.5*sites.op("S-",b)*sites.op("S+",b+1);
+        gates.push_back(BondGate(sites,b,b+1,BondGate::tReal,tau,hh));
+        }
+
+    //Start from a Neel state, evolved for a while
+    //so that the bond dimension reaches maxdim
+    auto init = InitState(sites);
+    for(auto j : range1(N)) init.set(j,j%2==1 ? "Up" : "Dn");
+    auto psi0 = MPS(init);
+    auto args = Args("Cutoff=",1E-10,"MaxDim=",maxdim,"ShowPercent=",false);
+    gateTEvol(gates,2.,tau,psi0,{args,"Method=","Parallel"});
+    printfln("N = %d, max bond dimension %d, %d thread(s)",N,maxLinkDim(psi0),getNThread());
+
+    auto run = [&](std::string method, MPS & psi)
+        {
+        psi = psi0;
+        auto start = std::chrono::steady_clock::now();
+        gateTEvol(gates,ttotal,tau,psi,{args,"Method=",method});
+        auto end = std::chrono::steady_clock::now();
+        auto t = std::chrono::duration<double>(end-start).count();
+        printfln("%-10s %8.3f s",method,t);
+        return t;
+        };
+    MPS psi1,psi2;
+    auto t1 = run("Sequential",psi1);
+    auto t2 = run("Parallel",psi2);
+    printfln("Speedup %.2f, |<psi1|psi2>| = %.12f",t1/t2,std::abs(innerC(psi1,psi2)));
+
+    return 0;
+    }
@@ -0,0 +1,93 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//
+// Times complex matrix multiplication C = A*B with each
+// ZGemmMethod (Native zgemm, 3M, and the four-dgemm
+// emulator) over a range of square sizes, and reports the
+// smallest size m*n*k from which 3M beats the best of the
+// other two. That value can be passed to setZGemm3MSize
+// or exported as ITENSOR_ZGEMM_3M_SIZE.
+//
+// Usage: zgemm_bench [nrepeat]
+//
+#include <chrono>
+#include <cstdlib>
+#include "itensor/tensor/mat.h"
+#include "itensor/global.h"
+
+using namespace itensor;
+
+double
+timeGemm(CMatrix const& A,
+         CMatrix const& B,
+         ZGemmMethod method,
+         int nrepeat,
+         Real & err)
+    {
+    setZGemmMethod(ZGemmMethod::Native);
+    auto Cref = CMatrix(nrows(A),ncols(B));
+    gemm(makeRef(A),makeRef(B),makeRef(Cref),1.,0.);
+
+    setZGemmMethod(method);
+    auto C = CMatrix(nrows(A),ncols(B));
+    auto start = std::chrono::steady_clock::now();
+    for(int n = 0; n < nrepeat; ++n)
+        {
+        gemm(makeRef(A),makeRef(B),makeRef(C),1.,0.);
+        }
+    auto end = std::chrono::steady_clock::now();
+    setZGemmMethod(ZGemmMethod::Auto);
+    err = norm(C-Cref)/norm(Cref);
+    return std::chrono::duration<double>(end-start).count()/nrepeat;
+    }
+
+int
+main(int argc, char* argv[])
+    {
+    int nrepeat = 5;
+    if(argc > 1) nrepeat = std::atoi(argv[1]);
+
+    printfln("%-6s %-24s %-24s %-24s","n","native","3m","emulate");
+    long crossover = -1;
+    for(auto n : {16,32,48,64,96,128,192,256,384,512,768,1024})
+        {
+        auto A = CMatrix(n,n),
+             B = CMatrix(n,n);
+        for(auto& el : A) el = Cplx(Global::random(),Global::random());
+        for(auto& el : B) el = Cplx(Global::random(),Global::random());
+
+        auto times = std::vector<double>{};
+        printf("%-6d",n);
+        for(auto method : {ZGemmMethod::Native,ZGemmMethod::ThreeM,ZGemmMethod::Emulate})
+            {
+            Real err = 0;
+            times.push_back(timeGemm(A,B,method,nrepeat,err));
+            printf(" %10.6f s (err %.1E)",times.back(),err);
+            }
+        printf("\n");
+        if(times[1] < std::min(times[0],times[2]))
+            {
+            if(crossover < 0) crossover = long(n)*n*n;
+            }
+        else
+            {
+            crossover = -1;
+            }
+        }
+    if(crossover > 0) printfln("3M is fastest from m*n*k = %d (current setting %d)",crossover,getZGemm3MSize());
+    else              printfln("3M was not the fastest for the largest sizes (current setting %d)",getZGemm3MSize());
+    return 0;
+    }
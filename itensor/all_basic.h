@@ -29,6 +29,7 @@
 //
 
 #include "itensor/decomp.h"
+#include "itensor/contractsequence.h"
 #include "itensor/iterativesolvers.h"
 #include "itensor/util/input.h"
 #include "itensor/util/autovector.h"
@@ -0,0 +1,304 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <mutex>
+#include <functional>
+#include "itensor/contractsequence.h"
+
+namespace itensor {
+
+using ContractOrder = std::vector<std::pair<int,int>>;
+
+//Most tensors for which all orders are tried
+const int CONTRACT_SEQUENCE_MAX_EXACT = 6;
+
+const size_t CONTRACT_SEQUENCE_CACHE_SIZE = 2000;
+
+static CacheCounters&
+contractSequenceCounters()
+    {
+    static CacheCounters counters;
+    return counters;
+    }
+
+using ContractSequenceCache = LRUCache<PlanKey,ContractOrder,PlanKeyHash>;
+
+static std::mutex contractSequenceMutex;
+
+static ContractSequenceCache&
+contractSequenceCache()
+    {
+    static ContractSequenceCache cache(CONTRACT_SEQUENCE_CACHE_SIZE);
+    return cache;
+    }
+
+CacheStats
+contractSequenceCacheStats() { return CacheStats(contractSequenceCounters()); }
+
+void
+clearContractSequenceCache()
+    {
+    std::lock_guard<std::mutex> lock(contractSequenceMutex);
+    contractSequenceCache().clear();
+    contractSequenceCounters().hits = 0;
+    contractSequenceCounters().misses = 0;
+    }
+
+namespace detail {
+
+//
+// Network of tensors: each distinct index gets a label
+// (numbered in order of first appearance), each tensor
+// the bit mask of its labels. Since every label is on
+// at most two tensors, the open labels of the product
+// of a set of tensors are the xor of their masks.
+//
+struct SeqNetwork
+    {
+    std::vector<uint64_t> masks;
+    std::vector<double> dims;
+    bool valid = true;
+
+    SeqNetwork(std::vector<ITensor> const& ts);
+
+    double
+    size(uint64_t m) const
+        {
+        auto s = 1.;
+        for(size_t l = 0; m != 0; ++l, m >>= 1)
+            {
+            if(m & 1) s *= dims[l];
+            }
+        return s;
+        }
+
+    //Cost of contracting tensors with open labels a and b
+    double
+    cost(uint64_t a, uint64_t b) const { return size(a | b); }
+    };
+
+SeqNetwork::
+SeqNetwork(std::vector<ITensor> const& ts)
+    : masks(ts.size(),0)
+    {
+    auto seen = std::vector<Index>{};
+    auto count = std::vector<int>{};
+    for(auto n : range(ts))
+        {
+        for(auto& i : inds(ts[n]))
+            {
+            auto l = std::find(seen.begin(),seen.end(),i)-seen.begin();
+            if(l == long(seen.size()))
+                {
+                seen.push_back(i);
+                dims.push_back(double(dim(i)));
+                count.push_back(0);
+                }
+            if(l >= 64 || ++count[l] > 2)
+                {
+                valid = false;
+                return;
+                }
+            masks[n] |= (uint64_t(1) << l);
+            }
+        }
+    }
+
+//
+// Key of the network shape: for each tensor its
+// labels, followed by the dimension of every label
+//
+PlanKey
+seqKey(SeqNetwork const& net)
+    {
+    auto key = PlanKey{};
+    key.push_back(net.masks.size());
+    for(auto m : net.masks)
+        {
+        key.push_back(long(m & 0xffffffff));
+        key.push_back(long(m >> 32));
+        }
+    for(auto d : net.dims) key.push_back(long(d));
+    return key;
+    }
+
+ContractOrder
+leftToRight(size_t n)
+    {
+    auto order = ContractOrder{};
+    for(size_t k = 1; k < n; ++k) order.emplace_back(0,int(k));
+    return order;
+    }
+
+double
+orderCost(SeqNetwork const& net, ContractOrder const& order)
+    {
+    auto m = net.masks;
+    auto total = 0.;
+    for(auto& p : order)
+        {
+        total += net.cost(m[p.first],m[p.second]);
+        m[p.first] ^= m[p.second];
+        }
+    return total;
+    }
+
+//
+// Cheapest order, by dynamic programming
+// over subsets of the tensors
+//
+ContractOrder
+exactOrder(SeqNetwork const& net)
+    {
+    auto n = int(net.masks.size());
+    auto nsub = (1ul << n);
+    auto open = std::vector<uint64_t>(nsub,0);
+    auto best = std::vector<double>(nsub,0.);
+    auto split = std::vector<unsigned long>(nsub,0);
+    for(unsigned long S = 1; S < nsub; ++S)
+        {
+        auto low = (S & (~S+1));
+        auto rest = S ^ low;
+        open[S] = open[rest] ^ net.masks[__builtin_ctzl(S)];
+        if(rest == 0) continue;
+        best[S] = -1.;
+        //Subsets S1 holding the lowest tensor of S
+        //so that each split is only counted once
+        for(auto sub = rest; ; sub = (sub-1) & rest)
+            {
+            auto S1 = sub | low;
+            auto S2 = S ^ S1;
+            if(S2 != 0)
+                {
+                auto c = best[S1]+best[S2]+net.cost(open[S1],open[S2]);
+                if(best[S] < 0 || c < best[S])
+                    {
+                    best[S] = c;
+                    split[S] = S1;
+                    }
+                }
+            if(sub == 0) break;
+            }
+        }
+    auto order = ContractOrder{};
+    std::function<int(unsigned long)> build = [&](unsigned long S)
+        {
+        if((S & (S-1)) == 0) return int(__builtin_ctzl(S));
+        auto a = build(split[S]);
+        auto b = build(S ^ split[S]);
+        order.emplace_back(a,b);
+        return a;
+        };
+    build(nsub-1);
+    return order;
+    }
+
+//
+// Repeatedly contract the cheapest pair, preferring
+// pairs which share an index over outer products
+//
+ContractOrder
+greedyOrder(SeqNetwork const& net)
+    {
+    auto m = net.masks;
+    auto live = std::vector<int>(m.size());
+    for(auto n : range(live)) live[n] = n;
+    auto order = ContractOrder{};
+    while(live.size() > 1)
+        {
+        size_t bi = 0,
+               bj = 1;
+        auto bshared = false;
+        auto bcost = -1.,
+             bsize = -1.;
+        for(size_t i = 0; i < live.size(); ++i)
+        for(size_t j = i+1; j < live.size(); ++j)
+            {
+            auto a = m[live[i]],
+                 b = m[live[j]];
+            auto shared = (a & b) != 0;
+            auto c = net.cost(a,b);
+            auto s = net.size(a ^ b);
+            if(bcost < 0 || (shared && !bshared)
+               || (shared == bshared && (c < bcost || (c == bcost && s < bsize))))
+                {
+                bi = i;
+                bj = j;
+                bshared = shared;
+                bcost = c;
+                bsize = s;
+                }
+            }
+        order.emplace_back(live[bi],live[bj]);
+        m[live[bi]] ^= m[live[bj]];
+        live.erase(live.begin()+bj);
+        }
+    return order;
+    }
+
+ContractOrder
+findOrder(SeqNetwork const& net)
+    {
+    auto n = net.masks.size();
+    if(n <= size_t(CONTRACT_SEQUENCE_MAX_EXACT)) return exactOrder(net);
+    auto greedy = greedyOrder(net);
+    auto ltr = leftToRight(n);
+    return (orderCost(net,greedy) < orderCost(net,ltr)) ? greedy : ltr;
+    }
+
+} //namespace detail
+
+ContractOrder
+contractOrder(std::vector<ITensor> const& ts)
+    {
+    if(ts.size() <= 2) return detail::leftToRight(ts.size());
+    auto net = detail::SeqNetwork(ts);
+    if(!net.valid) return detail::leftToRight(ts.size());
+
+    auto key = detail::seqKey(net);
+        {
+        std::lock_guard<std::mutex> lock(contractSequenceMutex);
+        auto* order = contractSequenceCache().find(key);
+        if(order)
+            {
+            ++contractSequenceCounters().hits;
+            return *order;
+            }
+        }
+    ++contractSequenceCounters().misses;
+    auto order = detail::findOrder(net);
+    std::lock_guard<std::mutex> lock(contractSequenceMutex);
+    contractSequenceCache().insert(key,order);
+    return order;
+    }
+
+ITensor
+contractSequence(std::vector<ITensor> const& ts)
+    {
+    if(ts.empty()) throw ITError("contractSequence: no tensors to contract");
+    if(ts.size() == 1) return ts.front();
+    if(ts.size() == 2) return ts[0]*ts[1];
+    auto T = ts;
+    auto last = 0;
+    for(auto& p : contractOrder(ts))
+        {
+        T[p.first] *= T[p.second];
+        T[p.second] = ITensor();
+        last = p.first;
+        }
+    return std::move(T[last]);
+    }
+
+} //namespace itensor
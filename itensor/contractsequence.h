@@ -0,0 +1,67 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_CONTRACTSEQUENCE_H
+#define __ITENSOR_CONTRACTSEQUENCE_H
+
+#include "itensor/itensor.h"
+#include "itensor/util/lrucache.h"
+
+namespace itensor {
+
+//
+// contractSequence({A,B,C,...}) - the product A*B*C*...
+// of a list of ITensors, contracted pairwise in the
+// order estimated to be the cheapest rather than
+// strictly from left to right
+//
+// o The cost of contracting two tensors is taken to be
+//   the product of the dimensions of all of their
+//   indices (the dense flop count). For up to six
+//   tensors every order is considered; for more the
+//   cheapest pair is contracted first, repeatedly, and
+//   the result is used only if it beats left to right.
+// o The order found is cached, keyed on the shape of
+//   the network (which tensors share which indices and
+//   the index dimensions), so repeated calls such as
+//   the environment updates of a sweep reuse it.
+// o If an index appears on more than two of the tensors
+//   the order matters for which copies are contracted;
+//   then the tensors are simply contracted left to right.
+//
+ITensor
+contractSequence(std::vector<ITensor> const& ts);
+
+//
+// Order used by contractSequence: contract the
+// tensors in slots (a,b) of each pair in turn,
+// putting the result in slot a
+//
+std::vector<std::pair<int,int>>
+contractOrder(std::vector<ITensor> const& ts);
+
+//
+// Hits and misses of the cache of
+// contraction orders, and clearing it
+//
+CacheStats
+contractSequenceCacheStats();
+
+void
+clearContractSequenceCache();
+
+} //namespace itensor
+
+#endif
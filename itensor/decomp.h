@@ -28,6 +28,19 @@ namespace itensor {
 // Factors a tensor AA such that AA=U*D*V
 // with D diagonal, real, and non-negative.
 //
+// The Arg "SVDMethod" selects the algorithm used
+// for each block: "recursive" (default), or
+// LAPACK's "gesdd" or "gesvd" (see tensor/algs.h).
+//
+// When MaxDim keeps only a small fraction
+// (below "SVDRandomizedRatio", default 0.2) of a block's
+// singular values, only the leading MaxDim+"SVDOversample"
+// (default 10) are computed with a randomized SVD using
+// "SVDPowerIter" (default 2) power iterations.
+// The weight of the rest still counts toward the
+// truncation error. Set "SVDRandomized" to true or false
+// to always or never use the randomized SVD when truncating.
+//
 Spectrum 
 svd(ITensor const& AA, ITensor& U, ITensor& D, ITensor& V, 
     Args args = Args::global());
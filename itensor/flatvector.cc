@@ -0,0 +1,426 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <algorithm>
+#include "itensor/flatvector.h"
+#include "itensor/itdata/applyfunc.h"
+#include "itensor/tensor/lapack_wrap.h"
+#include "itensor/tensor/slicemat.h"
+
+namespace itensor {
+
+FlatLayout::
+FlatLayout(ITensor const& T)
+  : is_(itensor::inds(T)),
+    qn_(itensor::hasQNs(T))
+    {
+    if(qn_)
+        {
+        if(!T.store()) throw ITError("FlatLayout: QN ITensor has no storage");
+        auto d = QDenseReal{};
+        size_ = d.updateOffsets(is_,div(T));
+        offsets_ = std::move(d.offsets);
+        }
+    else
+        {
+        size_ = dim(is_);
+        }
+    }
+
+FlatLayout::
+FlatLayout(IndexSet const& is,
+           QN const& flux)
+  : is_(is),
+    qn_(itensor::hasQNs(is))
+    {
+    if(qn_)
+        {
+        auto d = QDenseReal{};
+        size_ = d.updateOffsets(is_,flux);
+        offsets_ = std::move(d.offsets);
+        }
+    else
+        {
+        size_ = dim(is_);
+        }
+    }
+
+namespace detail {
+
+bool
+sameOffsets(std::vector<BlOf> const& o1,
+            std::vector<BlOf> const& o2)
+    {
+    if(o1.size() != o2.size()) return false;
+    for(auto n : range(o1.size()))
+        {
+        if(o1[n].block != o2[n].block || o1[n].offset != o2[n].offset) return false;
+        }
+    return true;
+    }
+
+void
+setFlat(Real & x, Real v) { x = v; }
+void
+setFlat(Cplx & x, Real v) { x = v; }
+void
+setFlat(Cplx & x, Cplx v) { x = v; }
+void
+setFlat(Real & x, Cplx v)
+    {
+    if(v.imag() != 0.) throw ITError("flatView: complex ITensor in a real flat vector");
+    x = v.real();
+    }
+
+//Checks whether storage already has the
+//layout L and element type V
+template<typename V>
+struct HasFlatLayout
+    {
+    FlatLayout const& L;
+    bool ok = false;
+
+    V const* data = nullptr;
+
+    HasFlatLayout(FlatLayout const& L_) : L(L_) { }
+
+    void
+    operator()(Dense<V> const& d)
+        {
+        ok = !L.hasQNs() && d.size() == L.size();
+        data = d.data();
+        }
+
+    void
+    operator()(QDense<V> const& d)
+        {
+        ok = L.hasQNs() && sameOffsets(d.offsets,L.offsets());
+        data = d.data();
+        }
+
+    template<typename D>
+    void
+    operator()(D const& d) { }
+    };
+
+template<typename V>
+struct FlatData
+    {
+    V* data = nullptr;
+
+    void
+    operator()(Dense<V> & d) { data = d.data(); }
+
+    void
+    operator()(QDense<V> & d) { data = d.data(); }
+    };
+
+//Copies storage into the layout L
+template<typename V>
+struct Relayout
+    {
+    FlatLayout const& L;
+    std::vector<V> data;
+
+    Relayout(FlatLayout const& L_) : L(L_), data(L_.size(),0.) { }
+
+    template<typename W>
+    void
+    operator()(Dense<W> const& d)
+        {
+        if(L.hasQNs() || d.size() != L.size()) throw ITError("flatView: Dense storage does not fit the layout");
+        for(auto n : range(d.size())) setFlat(data[n],d.store[n]);
+        }
+
+    template<typename W>
+    void
+    operator()(QDense<W> const& d)
+        {
+        if(!L.hasQNs()) throw ITError("flatView: QDense storage does not fit the layout");
+        auto& lo = L.offsets();
+        for(auto b : range(d.offsets.size()))
+            {
+            auto& bo = d.offsets[b];
+            auto bend = (b+1 < d.offsets.size()) ? d.offsets[b+1].offset : long(d.size());
+            auto it = std::lower_bound(lo.begin(),lo.end(),bo.block,
+                                       [](BlOf const& o, long blk) { return o.block < blk; });
+            if(it == lo.end() || it->block != bo.block)
+                {
+                for(auto n : range(bo.offset,bend))
+                    {
+                    if(d.store[n] != W(0.)) throw ITError("flatView: ITensor has a block not in the layout");
+                    }
+                continue;
+                }
+            for(auto n : range(bend-bo.offset)) setFlat(data[it->offset+n],d.store[bo.offset+n]);
+            }
+        }
+
+    template<typename D>
+    void
+    operator()(D const& d) { throw ITError("flatView: ITensor storage must be Dense or QDense"); }
+    };
+
+bool
+sameOrder(IndexSet const& is1,
+          IndexSet const& is2)
+    {
+    if(order(is1) != order(is2)) return false;
+    for(auto n : range1(order(is1)))
+        {
+        if(is1(n) != is2(n)) return false;
+        }
+    return true;
+    }
+
+} //namespace detail
+
+template<typename V>
+VecRef<V>
+flatView(ITensor & T, FlatLayout const& L)
+    {
+    if(!T.store()) throw ITError("flatView: ITensor has no storage");
+    if(!detail::sameOrder(T.inds(),L.inds())) T.permute(L.inds());
+    T.scaleTo(1.);
+
+    auto check = detail::HasFlatLayout<V>(L);
+    applyFunc(check,ITensor::const_storage_ptr(T.store()));
+    if(!check.ok)
+        {
+        auto R = detail::Relayout<V>(L);
+        applyFunc(R,ITensor::const_storage_ptr(T.store()));
+        if(L.hasQNs()) T = ITensor(L.inds(),QDense<V>(L.offsets(),std::move(R.data)));
+        else           T = ITensor(L.inds(),Dense<V>(std::move(R.data)));
+        }
+    auto f = detail::FlatData<V>{};
+    applyFunc(f,T.store());
+    return makeVecRef(f.data,L.size());
+    }
+template VecRef<Real> flatView(ITensor &, FlatLayout const&);
+template VecRef<Cplx> flatView(ITensor &, FlatLayout const&);
+
+template<typename V>
+ITensor
+toITensor(VecRefc<V> const& v, FlatLayout const& L)
+    {
+    if(v.size() != L.size()) throw ITError("toITensor: flat vector has wrong size");
+    auto data = std::vector<V>(v.begin(),v.end());
+    if(L.hasQNs()) return ITensor(L.inds(),QDense<V>(L.offsets(),std::move(data)));
+    return ITensor(L.inds(),Dense<V>(std::move(data)));
+    }
+template ITensor toITensor(VecRefc<Real> const&, FlatLayout const&);
+template ITensor toITensor(VecRefc<Cplx> const&, FlatLayout const&);
+
+namespace detail {
+
+//Data of T in the layout L, read in place
+//if T already has it (avoiding a copy of
+//storage shared with other ITensors),
+//otherwise from a copy kept in tmp
+template<typename V>
+V const*
+flatData(ITensor const& T,
+         FlatLayout const& L,
+         ITensor & tmp)
+    {
+    if(!T.store()) throw ITError("flatData: ITensor has no storage");
+    if(sameOrder(T.inds(),L.inds()) && T.scale() == LogNum(1.))
+        {
+        auto check = HasFlatLayout<V>(L);
+        applyFunc(check,T.store());
+        if(check.ok) return check.data;
+        }
+    tmp = T;
+    return flatView<V>(tmp,L).data();
+    }
+
+//Size of block b of the layout L
+size_t
+blockSize(FlatLayout const& L, size_t b)
+    {
+    auto& lo = L.offsets();
+    auto end = (b+1 < lo.size()) ? size_t(lo[b+1].offset) : L.size();
+    return end-lo[b].offset;
+    }
+
+template<typename V>
+ITensor
+stackImpl(std::vector<ITensor> const& x,
+          Index const& B,
+          FlatLayout const& L)
+    {
+    auto nb = x.size();
+    auto size = L.size();
+    auto data = std::vector<V>(nb*size);
+    ITensor tmp;
+    for(auto n : range(nb))
+        {
+        auto d = flatData<V>(x[n],L,tmp);
+        if(!L.hasQNs())
+            {
+            std::copy(d,d+size,data.data()+n*size);
+            continue;
+            }
+        //With B last (and a single block),
+        //block b of the result holds block b
+        //of every x[n] in turn
+        auto& lo = L.offsets();
+        for(auto b : range(lo.size()))
+            {
+            auto bs = blockSize(L,b);
+            std::copy(d+lo[b].offset,d+lo[b].offset+bs,data.data()+nb*lo[b].offset+n*bs);
+            }
+        }
+    auto is = IndexSet(L.inds(),B);
+    if(!L.hasQNs()) return ITensor(is,Dense<V>(std::move(data)));
+    auto offsets = L.offsets();
+    for(auto& o : offsets) o.offset *= nb;
+    return ITensor(is,QDense<V>(offsets,std::move(data)));
+    }
+
+template<typename V>
+std::vector<ITensor>
+unstackImpl(ITensor & S,
+            Index const& B,
+            FlatLayout const& LS,
+            FlatLayout const& L)
+    {
+    auto nb = dim(B);
+    auto size = L.size();
+    auto d = flatView<V>(S,LS).data();
+    auto x = std::vector<ITensor>(nb);
+    for(auto n : range(nb))
+        {
+        auto data = std::vector<V>(size);
+        if(!L.hasQNs())
+            {
+            std::copy(d+n*size,d+(n+1)*size,data.data());
+            x[n] = ITensor(L.inds(),Dense<V>(std::move(data)));
+            continue;
+            }
+        auto& lo = L.offsets();
+        for(auto b : range(lo.size()))
+            {
+            if(LS.offsets()[b].block != lo[b].block) throw ITError("unstack: unexpected blocks");
+            auto bs = blockSize(L,b);
+            auto src = d+LS.offsets()[b].offset+n*bs;
+            std::copy(src,src+bs,data.data()+lo[b].offset);
+            }
+        x[n] = ITensor(L.inds(),QDense<V>(L.offsets(),std::move(data)));
+        }
+    return x;
+    }
+
+} //namespace detail
+
+ITensor
+stack(std::vector<ITensor> const& x,
+      Index const& B)
+    {
+    if(x.empty()) throw ITError("stack: no tensors to stack");
+    if(size_t(dim(B)) != x.size()) throw ITError("stack: dim(B) must equal the number of tensors");
+    if(hasQNs(B) && nblock(B) != 1) throw ITError("stack: QN index B must have a single block");
+    auto L = FlatLayout(x.front());
+    for(auto& xn : x)
+        {
+        if(isComplex(xn)) return detail::stackImpl<Cplx>(x,B,L);
+        }
+    return detail::stackImpl<Real>(x,B,L);
+    }
+
+std::vector<ITensor>
+unstack(ITensor S,
+        Index const& B)
+    {
+    if(!hasIndex(S,B)) throw ITError("unstack: ITensor does not have index B");
+    //Move B to the end
+    auto inds = std::vector<Index>{};
+    for(auto& i : S.inds())
+        {
+        if(i != B) inds.push_back(i);
+        }
+    auto is = IndexSet(inds);
+    auto L = hasQNs(S) ? FlatLayout(is,div(S)) : FlatLayout(is);
+    S.permute(IndexSet(is,B));
+    auto LS = FlatLayout(S);
+    if(LS.offsets().size() != L.offsets().size()) throw ITError("unstack: unexpected blocks");
+    if(isComplex(S)) return detail::unstackImpl<Cplx>(S,B,LS,L);
+    return detail::unstackImpl<Real>(S,B,LS,L);
+    }
+
+void
+multDag(MatrixRefc const& M,
+        VectorRefc const& x,
+        VectorRef const& res)
+    {
+    mult(M,x,res,true);
+    }
+
+void
+multDag(CMatrixRefc const& M,
+        CVectorRefc const& x,
+        CVectorRef const& res)
+    {
+    //dag(M)*x = conj(transpose(M)*conj(x))
+    auto cx = conj(x);
+    mult(M,makeRefc(cx),res,true);
+    conjugate(res);
+    }
+
+void
+multDag(MatrixRefc const& M,
+        MatrixRefc const& X,
+        MatrixRef const& R)
+    {
+    gemm(transpose(M),X,R,1.,0.);
+    }
+
+void
+multDag(CMatrixRefc const& M,
+        CMatrixRefc const& X,
+        CMatrixRef const& R)
+    {
+    //dag(M)*X = conj(transpose(M)*conj(X))
+    auto cX = conj(X);
+    gemm(transpose(M),makeRefc(cX),R,1.,0.);
+    conjugate(R);
+    }
+
+void
+axpy(Real alpha,
+     VectorRefc const& x,
+     VectorRef const& y)
+    {
+    if(x.size() != y.size()) throw ITError("axpy: mismatched sizes");
+    daxpy_wrapper(x.size(),alpha,x.data(),stride(x),y.data(),stride(y));
+    }
+
+void
+axpy(Cplx alpha,
+     CVectorRefc const& x,
+     CVectorRef const& y)
+    {
+    if(x.size() != y.size()) throw ITError("axpy: mismatched sizes");
+    auto px = x.data();
+    auto py = y.data();
+    auto sx = stride(x),
+         sy = stride(y);
+    for(decltype(x.size()) n = 0; n < x.size(); ++n, px += sx, py += sy)
+        {
+        *py += alpha*(*px);
+        }
+    }
+
+} //namespace itensor
@@ -0,0 +1,166 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_FLATVECTOR_H
+#define __ITENSOR_FLATVECTOR_H
+
+#include "itensor/itensor.h"
+#include "itensor/tensor/mat.h"
+
+namespace itensor {
+
+//
+// FlatLayout - fixed storage layout (index order
+// and, for QN tensors, list of blocks) shared by
+// a set of ITensors, such as the vectors of an
+// iterative solver
+//
+// o FlatLayout(T) keeps the indices of T in their
+//   current order. For a QN tensor it holds every
+//   block allowed by the flux of T, so it also fits
+//   A*T for any linear map A conserving the flux.
+// o flatView(T,L) brings the storage of T into the
+//   layout L (a no-op when it already is, the usual
+//   case for tensors returned by the same map) and
+//   returns a VecRef to it, without copying.
+// o Solvers can then keep their basis as the columns
+//   of a Mat and form linear combinations and
+//   overlaps with single BLAS calls (mult, multDag)
+//   instead of one ITensor operation per vector.
+//
+class FlatLayout
+    {
+    IndexSet is_;
+    std::vector<BlOf> offsets_;
+    size_t size_ = 0;
+    bool qn_ = false;
+    public:
+
+    FlatLayout() { }
+
+    explicit
+    FlatLayout(ITensor const& T);
+
+    //Layout of tensors with indices is
+    //(and flux flux, if is has QNs)
+    FlatLayout(IndexSet const& is,
+               QN const& flux = QN());
+
+    IndexSet const&
+    inds() const { return is_; }
+
+    //Number of elements of a flat vector
+    size_t
+    size() const { return size_; }
+
+    bool
+    hasQNs() const { return qn_; }
+
+    //Blocks of a QN layout
+    std::vector<BlOf> const&
+    offsets() const { return offsets_; }
+
+    explicit operator bool() const { return bool(is_); }
+    };
+
+//
+// View of the storage of T as a flat vector
+// of element type V in the layout L.
+// T is permuted, scaled to 1, converted to
+// type V and re-blocked in place as needed
+// (throws if T has elements outside of L).
+// The view is valid until T is next modified.
+//
+template<typename V>
+VecRef<V>
+flatView(ITensor & T, FlatLayout const& L);
+
+//
+// ITensor with layout L holding a copy
+// of the flat vector v
+//
+template<typename V>
+ITensor
+toITensor(VecRefc<V> const& v, FlatLayout const& L);
+
+template<typename V>
+ITensor
+toITensor(Vec<V> const& v, FlatLayout const& L) { return toITensor(makeRefc(v),L); }
+
+//
+// Stack the tensors x[n], which must have the
+// same indices and flux, into one ITensor with
+// the extra index B (of dimension x.size())
+// as its last index, so that a linear map can
+// be applied to all of them at once.
+// For QN tensors B must have a single block
+// with zero QN, e.g. Index(QN(),x.size()).
+//
+ITensor
+stack(std::vector<ITensor> const& x,
+      Index const& B);
+
+//
+// Inverse of stack: the tensors S
+// for each value of its index B
+//
+std::vector<ITensor>
+unstack(ITensor S,
+        Index const& B);
+
+//
+// res = dag(M)*x, the overlaps of x with the
+// columns of M (conjugated in the complex case)
+//
+void
+multDag(MatrixRefc const& M,
+        VectorRefc const& x,
+        VectorRef const& res);
+
+void
+multDag(CMatrixRefc const& M,
+        CVectorRefc const& x,
+        CVectorRef const& res);
+
+//
+// R = dag(M)*X, the overlaps of the columns
+// of X with the columns of M
+//
+void
+multDag(MatrixRefc const& M,
+        MatrixRefc const& X,
+        MatrixRef const& R);
+
+void
+multDag(CMatrixRefc const& M,
+        CMatrixRefc const& X,
+        CMatrixRef const& R);
+
+//
+// y += alpha*x
+//
+void
+axpy(Real alpha,
+     VectorRefc const& x,
+     VectorRef const& y);
+
+void
+axpy(Cplx alpha,
+     CVectorRefc const& x,
+     CVectorRef const& y);
+
+} //namespace itensor
+
+#endif
@@ -20,6 +20,7 @@
 #include "itensor/decomp.h"
 #include "itensor/util/print_macro.h"
 #include "itensor/itdata/qutil.h"
+#include "itensor/util/threadpool.h"
 
 namespace itensor {
 
@@ -180,6 +181,9 @@ diagHImpl(ITensor H,
     else  // With QNs
         {
         auto compute_qns = args.getBool("ComputeQNs",false);
+        //Cap on threads used for the block diagonalizations,
+        //e.g. 1 if BLAS/LAPACK is itself multithreaded
+        auto decomp_nthread = args.getInt("DecompNThread",getNThread());
 
         if(H.order() != 2)
             {
@@ -228,19 +232,31 @@ diagHImpl(ITensor H,
         //   Store results in mmatrix and mvector.
         totaldsize = 0;
         totalUsize = 0;
+        auto costs = vector<double>(Nblock);
         for(auto b : range(Nblock))
             {
             auto& M = blocks[b].M;
-            auto& UU = Umats.at(b);
-            auto& d =  dvecs.at(b);
             auto rM = nrows(M),
                  cM = ncols(M);
+            dvecs.at(b) = makeVecRef(ddata.data()+totaldsize,rM);
+            Umats.at(b) = makeMatRef(Udata.data()+totalUsize,rM*cM,rM,cM);
+            costs[b] = double(rM)*rM*rM;
+            totaldsize += rM;
+            totalUsize += rM*cM;
+            }
 
-            d = makeVecRef(ddata.data()+totaldsize,rM);
-            UU = makeMatRef(Udata.data()+totalUsize,rM*cM,rM,cM);
-
-            diagHermitian(M,UU,d);
+        //The blocks are independent, so diagonalize
+        //them on the thread pool, largest first
+        parallelFor(threadPool(),costs,decomp_nthread,[&](size_t b)
+            {
+            auto& UU = Umats.at(b);
+            diagHermitian(blocks[b].M,UU,dvecs.at(b));
             conjugate(UU);
+            });
+
+        for(auto b : range(Nblock))
+            {
+            auto& d =  dvecs.at(b);
 
             alleig.insert(alleig.end(),d.begin(),d.end());
             if(compute_qns)
@@ -252,8 +268,6 @@ diagHImpl(ITensor H,
                     alleigqn.emplace_back(eig,q);
                     }
                 }
-            totaldsize += rM;
-            totalUsize += rM*cM;
             }
 
 
@@ -13,6 +13,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
+#include <mutex>
 //#include "itensor/util/iterate.h"
 #include "itensor/detail/gcounter.h"
 #include "itensor/detail/algs.h"
@@ -23,6 +24,8 @@
 #include "itensor/itdata/qdense.h"
 #include "itensor/itdata/qutil.h"
 #include "itensor/util/print_macro.h"
+#include "itensor/util/lrucache.h"
+#include "itensor/util/threadpool.h"
 
 using std::vector;
 using std::move;
@@ -99,6 +102,7 @@ updateOffsets(IndexSet const& is,
               QN         const& div)
     {
     offsets.clear();
+    clearBlockTable();
 
     if(order(is)==0)
         {
@@ -140,6 +144,41 @@ updateOffsets(IndexSet const& is,
     return totalsize;
     }
 
+template<typename T>
+std::shared_ptr<const QDenseBlockTable> QDense<T>::
+blockTable(IndexSet const& is) const
+    {
+    auto r = order(is);
+    auto t = std::atomic_load(&btable_);
+    if(t && t->blockinds.size() == offsets.size() && long(t->nblock.size()) == r)
+        {
+        bool same = true;
+        for(auto j : range(r)) 
+            if(t->nblock[j] != is[j].nblock()) 
+                {
+                same = false;
+                break;
+                }
+        if(same) return t;
+        }
+
+    auto nt = std::make_shared<QDenseBlockTable>();
+    nt->nblock.resize(r);
+    for(auto j : range(r)) nt->nblock[j] = is[j].nblock();
+    nt->blockinds.assign(offsets.size(),Labels(r,0));
+    nt->position.reserve(offsets.size());
+    for(auto n : range(offsets.size()))
+        {
+        if(r > 0) computeBlockInd(offsets[n].block,is,nt->blockinds[n]);
+        nt->position.emplace(offsets[n].block,long(n));
+        }
+    t = nt;
+    std::atomic_store(&btable_,t);
+    return t;
+    }
+template std::shared_ptr<const QDenseBlockTable> QDense<Real>::blockTable(IndexSet const&) const;
+template std::shared_ptr<const QDenseBlockTable> QDense<Cplx>::blockTable(IndexSet const&) const;
+
 long
 offsetOf(std::vector<BlOf> const& offsets,
          long blockind)
@@ -461,6 +500,131 @@ template void doTask(PlusEQ const&, QDense<Cplx> const&, QDense<Real> const&, Ma
 template void doTask(PlusEQ const&, QDense<Cplx> const&, QDense<Cplx> const&, ManageStore&);
 
 
+//
+// Plan for contracting two QDense storages:
+// the list of block-block contractions, grouped
+// by destination block of C, with the data offsets
+// and Range of each block. Depends only on the
+// indices, labels, and blocks present in A and B,
+// so it is cached and reused for contractions
+// with the same structure (e.g. during DMRG sweeps).
+//
+struct QBlockContract
+    {
+    long offA = 0,
+         offB = 0,
+         offC = 0;
+    Range Arange,
+          Brange,
+          Crange;
+    };
+
+struct QContractPlan
+    {
+    std::vector<std::vector<QBlockContract>> groups;
+    std::vector<double> costs; //estimated flops of each group
+    };
+
+const size_t BLOCK_CONTRACT_PLAN_CACHE_SIZE = 64;
+
+static CacheCounters&
+blockContractPlanCounters()
+    {
+    static CacheCounters counters;
+    return counters;
+    }
+
+using QContractPlanCache = LRUCache<PlanKey,std::shared_ptr<const QContractPlan>,PlanKeyHash>;
+
+static std::mutex blockContractPlanMutex;
+
+static QContractPlanCache&
+blockContractPlanCache()
+    {
+    static QContractPlanCache cache(BLOCK_CONTRACT_PLAN_CACHE_SIZE);
+    return cache;
+    }
+
+CacheStats
+blockContractPlanCacheStats() { return CacheStats(blockContractPlanCounters()); }
+
+void
+clearBlockContractPlanCache()
+    {
+    std::lock_guard<std::mutex> lock(blockContractPlanMutex);
+    blockContractPlanCache().clear();
+    blockContractPlanCounters().hits = 0;
+    blockContractPlanCounters().misses = 0;
+    }
+
+template<typename VA, typename VB>
+PlanKey
+blockContractPlanKey(IndexSet const& Ais, Labels const& Aind, QDense<VA> const& A,
+                     IndexSet const& Bis, Labels const& Bind, QDense<VB> const& B)
+    {
+    //Index ids determine the block structure of each index,
+    //labels which indices are contracted,
+    //and the offsets which blocks are present
+    auto key = PlanKey{};
+    auto addTensor = [&key](IndexSet const& is, Labels const& ind, std::vector<BlOf> const& offsets)
+        {
+        key.push_back(order(is));
+        for(auto j : range(order(is)))
+            {
+            key.push_back(static_cast<long>(is[j].id()));
+            key.push_back(static_cast<long>(is[j].dir()));
+            key.push_back(ind[j]);
+            }
+        key.push_back(offsets.size());
+        for(auto& bo : offsets) key.push_back(bo.block);
+        };
+    addTensor(Ais,Aind,A.offsets);
+    addTensor(Bis,Bind,B.offsets);
+    return key;
+    }
+
+template<typename VA, typename VB, typename VC>
+std::shared_ptr<const QContractPlan>
+makeQContractPlan(QDense<VA> const& A, IndexSet const& Ais,
+                  QDense<VB> const& B, IndexSet const& Bis,
+                  QDense<VC> & C, IndexSet const& Cis)
+    {
+    auto plan = std::make_shared<QContractPlan>();
+    auto group_of = std::unordered_map<long,size_t>{};
+    auto collect = 
+        [&plan,&group_of,&A,&B,&C,&Ais,&Bis,&Cis]
+        (DataRange<const VA> ablock, Labels const& Ablockind,
+         DataRange<const VB> bblock, Labels const& Bblockind,
+         DataRange<VC>       cblock, Labels const& Cblockind)
+        {
+        auto bc = QBlockContract{};
+        bc.offA = ablock.data()-A.data();
+        bc.offB = bblock.data()-B.data();
+        bc.offC = cblock.data()-C.data();
+        //Construct range objects for aref,bref,cref
+        //using IndexDim helper objects
+        bc.Arange.init(make_indexdim(Ais,Ablockind));
+        bc.Brange.init(make_indexdim(Bis,Bblockind));
+        bc.Crange.init(make_indexdim(Cis,Cblockind));
+
+        auto it = group_of.find(bc.offC);
+        if(it == group_of.end())
+            {
+            it = group_of.emplace(bc.offC,plan->groups.size()).first;
+            plan->groups.emplace_back();
+            plan->costs.push_back(0.);
+            }
+        //For a block GEMM with sizes m*k, k*n and m*n
+        //the flop count m*n*k is sqrt(sizeA*sizeB*sizeC)
+        plan->costs[it->second] += std::sqrt(double(dim(bc.Arange))
+                                            *double(dim(bc.Brange))
+                                            *double(dim(bc.Crange)));
+        plan->groups[it->second].push_back(std::move(bc));
+        };
+    loopContractedBlocks(A,Ais,B,Bis,C,Cis,collect);
+    return plan;
+    }
+
 template<typename VA, typename VB>
 void
 doTask(Contract& Con,
@@ -483,37 +647,61 @@ doTask(Contract& Con,
     auto nd = m.makeNewData<QDense<VC>>(Con.Nis,Cdiv);
     auto& C = *nd;
 
-    //Function to execute for each pair of
-    //contracted blocks of A and B
-    auto do_contract = 
-        [&Con,&Lind,&Rind,&Cind]
-        (DataRange<const VA> ablock, Labels const& Ablockind,
-         DataRange<const VB> bblock, Labels const& Bblockind,
-         DataRange<VC>       cblock, Labels const& Cblockind)
+    auto key = blockContractPlanKey(Con.Lis,Lind,A,Con.Ris,Rind,B);
+    auto plan = std::shared_ptr<const QContractPlan>{};
         {
-        Range Arange,
-              Brange,
-              Crange;
-        //Construct range objects for aref,bref,cref
-        //using IndexDim helper objects
-        Arange.init(make_indexdim(Con.Lis,Ablockind));
-        Brange.init(make_indexdim(Con.Ris,Bblockind));
-        Crange.init(make_indexdim(Con.Nis,Cblockind));
-
-        //"Wire up" TensorRef's pointing to blocks of A,B, and C
-        //we are working with
-        auto aref = makeRef(ablock,&Arange);
-        auto bref = makeRef(bblock,&Brange);
-        auto cref = makeRef(cblock,&Crange);
+        std::lock_guard<std::mutex> lock(blockContractPlanMutex);
+        auto* cached = blockContractPlanCache().find(key);
+        if(cached) plan = *cached;
+        }
+    if(plan)
+        {
+        ++blockContractPlanCounters().hits;
+        }
+    else
+        {
+        ++blockContractPlanCounters().misses;
+        plan = makeQContractPlan(A,Con.Lis,B,Con.Ris,C,Con.Nis);
+        std::lock_guard<std::mutex> lock(blockContractPlanMutex);
+        blockContractPlanCache().insert(key,plan);
+        }
 
-        //Compute cref += aref*bref
-        contract(aref,Lind,bref,Rind,cref,Cind,1.,1.);
+    //Contract all pairs of blocks of A and B
+    //which contribute to one block of C
+    auto do_group = 
+        [&A,&B,&C,&Lind,&Rind,&Cind]
+        (std::vector<QBlockContract> const& group)
+        {
+        for(auto& bc : group)
+            {
+            //"Wire up" TensorRef's pointing to blocks of A,B, and C
+            //we are working with
+            auto aref = makeTenRef(A.data(),bc.offA,A.size(),&bc.Arange);
+            auto bref = makeTenRef(B.data(),bc.offB,B.size(),&bc.Brange);
+            auto cref = makeTenRef(C.data(),bc.offC,C.size(),&bc.Crange);
+
+            //Compute cref += aref*bref
+            contract(aref,Lind,bref,Rind,cref,Cind,1.,1.);
+            }
         };
 
-    loopContractedBlocks(A,Con.Lis,
-                         B,Con.Ris,
-                         C,Con.Nis,
-                         do_contract);
+    //Groups write to distinct blocks of C, so they
+    //run in parallel if the thread pool has more than one thread
+    auto& pool = threadPool();
+    if(pool.nthread() > 1 && plan->groups.size() > 1)
+        {
+        auto tasks = std::vector<ThreadPool::Task>{};
+        tasks.reserve(plan->groups.size());
+        for(auto& g : plan->groups)
+            {
+            tasks.emplace_back([&g,&do_group]() { do_group(g); });
+            }
+        pool.run(tasks,plan->costs);
+        }
+    else
+        {
+        for(auto& g : plan->groups) do_group(g);
+        }
 
 #ifdef USESCALE
     Con.scalefac = computeScalefac(C);
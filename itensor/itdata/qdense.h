@@ -17,11 +17,14 @@
 #define __ITENSOR_QDENSE_H
 
 #include <vector>
+#include <memory>
+#include <unordered_map>
 #include "itensor/itdata/task_types.h"
 #include "itensor/itdata/itdata.h"
 #include "itensor/tensor/types.h"
 #include "itensor/detail/gcounter.h"
 #include "itensor/detail/call_rewrite.h"
+#include "itensor/util/lrucache.h"
 
 namespace itensor {
 
@@ -37,6 +40,35 @@ struct BlOf
     long offset;
     };
 
+//
+// Decoded block indices of a QDense: for each
+// entry of offsets, the location of the block
+// along every index (as computed by computeBlockInd),
+// plus a hash from block index to position in offsets.
+// Used to match blocks in contractions without
+// re-decoding or searching the offsets.
+//
+struct QDenseBlockTable
+    {
+    std::vector<long> nblock;
+        //^ nblock() of each index of the
+        //  IndexSet the table was built for
+    std::vector<Labels> blockinds;
+        //^ blockinds[n] is the block location 
+        //  of the block offsets[n].block
+    std::unordered_map<long,long> position;
+        //^ maps offsets[n].block to n
+
+    // Position in offsets of block with
+    // block index "block", or -1 if absent
+    long
+    find(long block) const
+        {
+        auto it = position.find(block);
+        return (it == position.end()) ? -1 : it->second;
+        }
+    };
+
 template<typename T>
 class QDense
     {
@@ -119,6 +151,23 @@ class QDense
     updateOffsets(IndexSet const& is,
                   QN const& div);
 
+    // Block table for the IndexSet is,
+    // built on first use and shared between
+    // copies of this QDense. Not serialized:
+    // read(...) leaves it to be rebuilt.
+    std::shared_ptr<const QDenseBlockTable>
+    blockTable(IndexSet const& is) const;
+
+    // Call after modifying offsets directly
+    void
+    clearBlockTable() { std::atomic_store(&btable_,std::shared_ptr<const QDenseBlockTable>{}); }
+
+    void
+    swapBlockTable(QDense & other) { btable_.swap(other.btable_); }
+
+    private:
+
+    mutable std::shared_ptr<const QDenseBlockTable> btable_;
     };
 
 const char*
@@ -168,6 +217,7 @@ read(std::istream & s, QDense<T> & dat)
     {
     itensor::read(s,dat.offsets);
     itensor::read(s,dat.store);
+    dat.clearBlockTable();
     }
 
 template<typename T>
@@ -177,6 +227,7 @@ swap(QDense<T> & d1,
     {
     d1.offsets.swap(d2.offsets);
     d1.store.swap(d2.store);
+    d1.swapBlockTable(d2);
     }
 
 template<typename T>
@@ -324,6 +375,19 @@ doTask(Contract& Con,
        QDense<VB> const& B,
        ManageStore& m);
 
+//
+// Contraction of QDense storage caches the
+// list of block-block contractions (offsets, 
+// block Ranges) keyed on the indices and blocks
+// of the two tensors. These report hits and
+// misses of this cache and clear it.
+//
+CacheStats
+blockContractPlanCacheStats();
+
+void
+clearBlockContractPlanCache();
+
 //TODO: complete implementation
 //template<typename VA, typename VB>
 //void
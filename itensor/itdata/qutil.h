@@ -16,7 +16,9 @@
 #ifndef __ITENSOR_QUTIL_H
 #define __ITENSOR_QUTIL_H
 
+#include <algorithm>
 #include "itensor/indexset.h"
+#include "itensor/itdata/qdense.h"
 
 namespace itensor {
 
@@ -110,18 +112,24 @@ getBlock(BlockSparse & d,
     return data_range_type{};
     }
 
+//
+// Calls callback for every pair of blocks of A
+// and B which contract into a block of C,
+// finding the blocks of B by walking a counter
+// over all block locations consistent with the block of A
+//
 template<typename BlockSparseA, 
          typename BlockSparseB,
          typename BlockSparseC,
          typename Callable>
 void
-loopContractedBlocks(BlockSparseA const& A,
-                     IndexSet const& Ais,
-                     BlockSparseB const& B,
-                     IndexSet const& Bis,
-                     BlockSparseC & C,
-                     IndexSet const& Cis,
-                     Callable & callback)
+loopContractedBlocksGCounter(BlockSparseA const& A,
+                             IndexSet const& Ais,
+                             BlockSparseB const& B,
+                             IndexSet const& Bis,
+                             BlockSparseC & C,
+                             IndexSet const& Cis,
+                             Callable & callback)
     {
     auto rA = Ais.order();
     auto rB = Bis.order();
@@ -208,6 +216,150 @@ loopContractedBlocks(BlockSparseA const& A,
         } //for A.offsets
     }
 
+template<typename BlockSparseA, 
+         typename BlockSparseB,
+         typename BlockSparseC,
+         typename Callable>
+void
+loopContractedBlocks(BlockSparseA const& A,
+                     IndexSet const& Ais,
+                     BlockSparseB const& B,
+                     IndexSet const& Bis,
+                     BlockSparseC & C,
+                     IndexSet const& Cis,
+                     Callable & callback)
+    {
+    loopContractedBlocksGCounter(A,Ais,B,Bis,C,Cis,callback);
+    }
+
+//
+// Version of loopContractedBlocks for QDense storage,
+// using the block tables of A, B, and C:
+// the blocks of B are keyed by their location along
+// the contracted indices, so that matching blocks of A
+// and B becomes a lookup of precomputed keys.
+// Calls callback in the same order as the general version.
+//
+template<typename VA, 
+         typename VB,
+         typename VC,
+         typename Callable>
+void
+loopContractedBlocks(QDense<VA> const& A,
+                     IndexSet const& Ais,
+                     QDense<VB> const& B,
+                     IndexSet const& Bis,
+                     QDense<VC> & C,
+                     IndexSet const& Cis,
+                     Callable & callback)
+    {
+    auto rA = Ais.order();
+    auto rB = Bis.order();
+    auto rC = Cis.order();
+    if(rA == 0 || rB == 0 || rC == 0)
+        {
+        loopContractedBlocksGCounter(A,Ais,B,Bis,C,Cis,callback);
+        return;
+        }
+
+    auto AtoC = IntArray(rA,-1);
+    auto BtoA = IntArray(rB,-1);
+    auto BtoC = IntArray(rB,-1);
+    for(auto ic : range(rC))
+        {
+        auto j = indexPosition(Ais,Cis[ic]);
+        if(j >= 0)
+            {
+            AtoC[j] = ic;
+            }
+        else
+            {
+            j = indexPosition(Bis,Cis[ic]);
+            BtoC[j] = ic;
+            }
+        }
+    for(auto ib : range(rB))
+    for(auto ia : range(rA))
+        {
+        if(Ais[ia] == Bis[ib])
+            {
+            BtoA[ib] = ia;
+            break;
+            }
+        }
+
+    auto Atab = A.blockTable(Ais);
+    auto Btab = B.blockTable(Bis);
+    auto Ctab = C.blockTable(Cis);
+
+    //Key of a block: its location along the contracted
+    //indices, as a mixed-radix number in the order of B
+    auto contractedKey = [&Bis,&BtoA,rB](auto const& blockind, bool onA)
+        {
+        long key = 0,
+             str = 1;
+        for(auto ib : range(rB))
+            {
+            if(BtoA[ib] == -1) continue;
+            key += str*(onA ? blockind[BtoA[ib]] : blockind[ib]);
+            str *= Bis[ib].nblock();
+            }
+        return key;
+        };
+
+    //Sorted (key,position) pairs for the blocks of B;
+    //within a key, blocks stay in order of increasing
+    //block index as when walking a GCounter
+    auto Bkeys = std::vector<std::pair<long,long>>(B.offsets.size());
+    for(auto nb : range(B.offsets.size()))
+        {
+        Bkeys[nb] = std::make_pair(contractedKey(Btab->blockinds[nb],false),long(nb));
+        }
+    std::sort(Bkeys.begin(),Bkeys.end());
+
+    auto Cstr = IntArray(rC,1);
+    for(auto ic : range1(rC-1)) Cstr[ic] = Cstr[ic-1]*Cis[ic-1].nblock();
+
+    auto Cblockind = IntArray(rC,0);
+    for(auto na : range(A.offsets.size()))
+        {
+        auto& Ablockind = Atab->blockinds[na];
+        auto key = contractedKey(Ablockind,true);
+        auto match = std::equal_range(Bkeys.begin(),Bkeys.end(),std::make_pair(key,0l),
+                                      [](std::pair<long,long> const& a, std::pair<long,long> const& b)
+                                      { return a.first < b.first; });
+        if(match.first == match.second) continue;
+
+        for(auto iA : range(rA))
+            {
+            if(AtoC[iA] != -1) Cblockind[AtoC[iA]] = Ablockind[iA];
+            }
+        auto ablock = makeDataRange(A.data(),A.offsets[na].offset,A.size());
+
+        for(auto it = match.first; it != match.second; ++it)
+            {
+            auto nb = it->second;
+            auto& Bblockind = Btab->blockinds[nb];
+            for(auto iB : range(rB))
+                {
+                if(BtoC[iB] != -1) Cblockind[BtoC[iB]] = Bblockind[iB];
+                }
+            long cb = 0;
+            for(auto ic : range(rC)) cb += Cblockind[ic]*Cstr[ic];
+            auto nc = Ctab->find(cb);
+            assert(nc >= 0);
+            if(nc < 0) continue;
+
+            auto bblock = makeDataRange(B.data(),B.offsets[nb].offset,B.size());
+            auto cblock = makeDataRange(C.data(),C.offsets[nc].offset,C.size());
+
+            callback(ablock,Ablockind,
+                     bblock,Bblockind,
+                     cblock,Cblockind);
+            }
+        }
+    }
+
 
 } //namespace itensor
 
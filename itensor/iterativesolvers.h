@@ -18,6 +18,7 @@
 #include "itensor/util/iterate.h"
 #include "itensor/itensor.h"
 #include "itensor/tensor/algs.h"
+#include "itensor/flatvector.h"
 
 
 namespace itensor {
@@ -42,6 +43,14 @@ davidson(BigMatrixT const& A,
 // (BigMatrixT objects must implement the methods product, size and diag.)
 // Returns a vector of the N smallest eigenvalues corresponding
 // to the set of eigenvectors phi.
+// Named argument "DavidsonMethod" selects how they are found:
+// o "Single" (default): one eigenvector at a time, adding
+//   one vector (one product) to the subspace per iteration
+// o "Block": all N together, adding the residuals of all
+//   unconverged eigenvectors per iteration and applying A
+//   to them at once with A.productBatch(x,Ax) if
+//   BigMatrixT provides it ("MaxIter" then counts
+//   block iterations)
 //
 template <class BigMatrixT>
 std::vector<Real>
@@ -81,11 +90,12 @@ davidson(BigMatrixT const& A,
     return eigs.front();
     }
 
-template <class BigMatrixT>
+template <typename T, class BigMatrixT>
 std::vector<Real>
-davidson(BigMatrixT const& A, 
-         std::vector<ITensor>& phi,
-         Args const& args)
+davidsonImpl(BigMatrixT const& A, 
+             std::vector<ITensor>& phi,
+             ITensor& Aphi0,
+             Args const& args)
     {
     auto maxiter_ = args.getSizeT("MaxIter",2);
     auto errgoal_ = args.getReal("ErrGoal",1E-14);
@@ -95,17 +105,6 @@ davidson(BigMatrixT const& A,
     Real Approx0 = 1E-12;
 
     auto nget = phi.size();
-    if(nget == 0) Error("No initial vectors passed to davidson.");
-    for(auto j : range(nget))
-        {
-        auto nrm = norm(phi[j]);
-        while(nrm == 0.0) 
-            {
-            phi[j].randomize();
-            nrm = norm(phi[j]);
-            }
-        phi[j] *= 1./nrm;
-        }
 
     size_t maxsize = A.size();
     size_t actual_maxiter = std::min(maxiter_,size_t(maxsize-1));
@@ -115,43 +114,40 @@ davidson(BigMatrixT const& A,
                  (maxsize-1), maxiter_, actual_maxiter);
         }
 
-    if(dim(inds(phi.front())) != maxsize)
-        {
-        println("dim(inds(phi.front())) = ",dim(inds(phi.front())));
-        println("A.size() = ",A.size());
-        Error("davidson: size of initial vector should match linear matrix size");
-        }
-
-    auto V = std::vector<ITensor>(actual_maxiter+2);
-    auto AV = std::vector<ITensor>(actual_maxiter+2);
+    //The basis vectors V and their products AV
+    //are the columns of flat matrices, so that
+    //linear combinations and overlaps are gemv's
+    auto L = FlatLayout(phi.front());
+    auto vsize = L.size();
+    auto V = Mat<T>(vsize,actual_maxiter+2);
+    auto AV = Mat<T>(vsize,actual_maxiter+2);
 
     //Storage for Matrix that gets diagonalized 
     //set to NAN to ensure failure if we use uninitialized elements
-    auto M = CMatrix(actual_maxiter+2,actual_maxiter+2);
-    for(auto& el : M) el = Cplx(NAN,NAN);
+    auto M = Mat<T>(actual_maxiter+2,actual_maxiter+2);
+    for(auto& el : M) el = NAN;
 
-    auto NC = CVector(actual_maxiter+2);
+    auto NC = Vec<T>(actual_maxiter+2);
+    auto Vq = Vec<T>(actual_maxiter+2);
 
     //Mref holds current projection of A into V's
     auto Mref = subMatrix(M,0,1,0,1);
 
-    //Get diagonal of A to use later
-    //auto Adiag = A.diag();
-
     Real qnorm = NAN;
 
     Vector D;
-    CMatrix U;
+    Mat<T> U;
 
     Real last_lambda = 1000.;
     auto eigs = std::vector<Real>(nget,NAN);
+    //Eigenvectors as flat vectors
+    auto phif = std::vector<Vec<T>>(nget);
+    auto q = Vec<T>(vsize);
 
-    V[0] = phi.front();
-    START_TIMER(21);
-    A.product(V[0],AV[0]);
-    STOP_TIMER(21);
+    column(V,0) &= flatView<T>(phi.front(),L);
+    column(AV,0) &= flatView<T>(Aphi0,L);
 
-    auto initEn = eltC((dag(V[0])*AV[0])).real();
+    auto initEn = std::real(column(V,0)*column(AV,0));
 
     if(debug_level_ > 2)
         printfln("Initial Davidson energy = %.10f",initEn);
@@ -165,9 +161,9 @@ davidson(BigMatrixT const& A,
         //and compute the residual q
 
         auto ni = ii+1; 
-        auto& q = V.at(ni);
-        auto& phi_t = phi.at(t);
+        auto& phi_t = phif.at(t);
         auto& lambda = eigs.at(t);
+        if(phi_t.size() != vsize) phi_t = Vec<T>(vsize);
 
         //Step A (or I) of Davidson (1975)
         if(ii == 0)
@@ -175,8 +171,9 @@ davidson(BigMatrixT const& A,
             lambda = initEn;
             stdx::fill(Mref,lambda);
             //Calculate residual q
-            q = AV[0] - lambda*V[0];
-            //printfln("ii=%d, q = \n%f",ii,q);
+            phi_t &= column(V,0);
+            q &= column(AV,0);
+            axpy(T(-lambda),column(V,0),makeRef(q));
             }
         else // ii != 0
             {
@@ -189,30 +186,24 @@ davidson(BigMatrixT const& A,
             Mref *= -1;
             D *= -1;
             lambda = D(t);
-            phi_t = U(0,t)*V[0];
-            q     = U(0,t)*AV[0];
-            for(auto k : range1(ii))
-                {
-                phi_t += U(k,t)*V[k];
-                q     += U(k,t)*AV[k];
-                }
+            mult<T>(columns(V,0,ni),column(U,t),makeRef(phi_t));
+            mult<T>(columns(AV,0,ni),column(U,t),makeRef(q));
 
             //Step B of Davidson (1975)
             //Calculate residual q
-            q += (-lambda)*phi_t;
+            axpy(T(-lambda),phi_t,makeRef(q));
 
             //Fix sign
-            if(U(0,t).real() < 0)
+            if(std::real(U(0,t)) < 0)
                 {
-                phi_t *= -1;
-                q *= -1;
+                makeRef(phi_t) *= -1.;
+                makeRef(q) *= -1.;
                 }
             if(debug_level_ >= 3)
                 {
                 println("D = ",D);
                 printfln("lambda = %.10f",lambda);
                 }
-            //printfln("ii=%d, full q = \n%f",ii,q);
             }
 
         //Step C of Davidson (1975)
@@ -270,48 +261,29 @@ davidson(BigMatrixT const& A,
         //TODO add preconditioner step (may require
         //non-contracting product to do efficiently)
         //
-        //if(Adiag)
-        //    {
-        //    //Function which applies the mapping
-        //    // f(x,theta) = 1/(theta - x)
-        //    auto precond = [theta=lambda.real()](Real val)
-        //        {
-        //        return (theta==val) ? 0 : 1./(theta-val);
-        //        };
-        //    auto cond= Adiag;
-        //    cond.apply(precond);
-        //    q /= cond;
-        //    }
 
         //Step E and F of Davidson (1975)
         //Do Gram-Schmidt on d (Npass times)
         //to include it in the subbasis
+        {
         int Npass = 1;
-        auto Vq = std::vector<Cplx>(ni);
+        auto Vb = columns(V,0,ni);
+        auto Vqb = subVector(Vq,0,ni);
         int pass = 1;
         int tot_pass = 0;
         while(pass <= Npass)
             {
             if(debug_level_ >= 3) println("Doing orthog pass");
             ++tot_pass;
-            for(auto k : range(ni))
-                {
-                Vq[k] = (dag(V[k])*q).eltC();
-                //printfln("pass=%d Vq[%d] = %s",pass,k,Vq[k]);
-                }
-            for(auto k : range(ni))
-                {
-                q += (-Vq[k])*V[k];
-                }
+            multDag(Vb,q,Vqb);
+            multSub<T>(Vb,Vqb,makeRef(q));
             auto qnrm = norm(q);
-            //printfln("pass=%d qnrm=%s",pass,qnrm);
             if(qnrm < 1E-10)
                 {
                 //Orthogonalization failure,
                 //try randomizing
                 if(debug_level_ >= 2) println("Vector not independent, randomizing");
-                q = V.at(ni-1);
-                q.randomize();
+                randomize(q);
                 qnrm = norm(q);
                 //Do another orthog pass
                 --pass;
@@ -335,22 +307,11 @@ davidson(BigMatrixT const& A,
                     goto done;
                     }
                 }
-            q *= 1./qnrm;
-            //q.scaleTo(1.);
+            makeRef(q) *= 1./qnrm;
             ++pass;
             }
         if(debug_level_ >= 3) println("Done with orthog step, tot_pass=",tot_pass);
-
-        //Check V's are orthonormal
-        //Mat Vo(ni+1,ni+1,NAN); 
-        //for(int r = 1; r <= ni+1; ++r)
-        //for(int c = r; c <= ni+1; ++c)
-        //    {
-        //    z = (dag(V[r-1])*V[c-1]).eltC();
-        //    Vo(r,c) = abs(z);
-        //    Vo(c,r) = Vo(r,c);
-        //    }
-        //println("Vo = \n",Vo);
+        }
 
         if(debug_level_ >= 3)
             {
@@ -364,18 +325,21 @@ davidson(BigMatrixT const& A,
         //Step G of Davidson (1975)
         //Expand AV and M
         //for next step
+        column(V,ni) &= q;
+        {
+        auto Vn = toITensor<T>(column(V,ni),L);
+        ITensor AVn;
         START_TIMER(21);
-        A.product(V[ni],AV[ni]);
+        A.product(Vn,AVn);
         STOP_TIMER(21);
+        column(AV,ni) &= flatView<T>(AVn,L);
+        }
 
         //Step H of Davidson (1975)
         //Add new row and column to M
         Mref = subMatrix(M,0,ni+1,0,ni+1);
         auto newCol = subVector(NC,0,1+ni);
-        for(auto k : range(ni+1))
-            {
-            newCol(k) = (dag(V.at(k))*AV.at(ni)).eltC();
-            }
+        multDag(columns(V,0,ni+1),column(AV,ni),newCol);
         column(Mref,ni) &= newCol;
         row(Mref,ni) &= conj(newCol);
 
@@ -385,25 +349,22 @@ davidson(BigMatrixT const& A,
 
     done:
 
-    //TODO: put this back?
-    //for(auto& T : phi)
-    //    {
-    //    if(T.scale().logNum() > 2) T.scaleTo(1.);
-    //    }
-
     //Compute any remaining eigenvalues and eigenvectors requested
     //(zero indexed) value of t indicates how many have been "targeted" so far
+    //(phif.at(t) is not yet set if we stopped right
+    //after moving on to target t)
+    if(phif.at(t).size() != vsize && nrows(U) > t) --t;
     if(debug_level_ >= 2 && t+1 < nget) printfln("Max iter. reached, computing remaining %d evecs",nget-t-1);
     for(auto j : range(t+1,nget))
         {
         eigs.at(j) = D(j);
-        auto& phi_j = phi.at(j);
-        auto Nr = size_t(nrows(U));
-        phi_j = U(0,j)*V[0];
-        for(auto k : range1(std::min(V.size(),Nr)-1))
-            {
-            phi_j += U(k,j)*V[k];
-            }
+        auto Nr = std::min(ncols(V),size_t(nrows(U)));
+        phif.at(j) = Vec<T>(vsize);
+        mult<T>(columns(V,0,Nr),subVector(column(U,j),0,Nr),makeRef(phif.at(j)));
+        }
+    for(auto j : range(nget))
+        {
+        if(phif.at(j).size() == vsize) phi.at(j) = toITensor(phif.at(j),L);
         }
 
     if(debug_level_ >= 4)
@@ -413,7 +374,7 @@ davidson(BigMatrixT const& A,
         for(auto r : range(iter+1))
         for(auto c : range(r,iter+1))
             {
-            auto z = (dag(V[r])*V[c]).eltC();
+            auto z = column(V,r)*column(V,c);
             Vo_final(r,c) = std::abs(z);
             Vo_final(c,r) = Vo_final(r,c);
             }
@@ -434,6 +395,342 @@ davidson(BigMatrixT const& A,
     return eigs;
     }
 
+namespace davidson_details {
+
+template<class BigMatrixT>
+auto
+productBatchImpl(stdx::choice<1>,
+                 BigMatrixT const& A,
+                 std::vector<ITensor> const& x,
+                 std::vector<ITensor> & Ax)
+    -> decltype(A.productBatch(x,Ax),void())
+    {
+    A.productBatch(x,Ax);
+    }
+
+template<class BigMatrixT>
+void
+productBatchImpl(stdx::choice<2>,
+                 BigMatrixT const& A,
+                 std::vector<ITensor> const& x,
+                 std::vector<ITensor> & Ax)
+    {
+    Ax.resize(x.size());
+    for(auto n : range(x.size())) A.product(x[n],Ax[n]);
+    }
+
+//Ax[n] = A*x[n], with a single call to
+//A.productBatch if BigMatrixT has one
+template<class BigMatrixT>
+void
+productBatch(BigMatrixT const& A,
+             std::vector<ITensor> const& x,
+             std::vector<ITensor> & Ax)
+    {
+    START_TIMER(21);
+    productBatchImpl(stdx::select_overload{},A,x,Ax);
+    STOP_TIMER(21);
+    }
+
+} //namespace davidson_details
+
+template <typename T, class BigMatrixT>
+std::vector<Real>
+davidsonBlockImpl(BigMatrixT const& A, 
+                  std::vector<ITensor>& phi,
+                  std::vector<ITensor>& Aphi,
+                  Args const& args)
+    {
+    auto maxiter_ = args.getSizeT("MaxIter",2);
+    auto errgoal_ = args.getReal("ErrGoal",1E-14);
+    auto debug_level_ = args.getInt("DebugLevel",-1);
+    auto miniter_ = args.getSizeT("MinIter",1);
+
+    Real Approx0 = 1E-12;
+
+    auto nget = phi.size();
+
+    auto L = FlatLayout(phi.front());
+    auto vsize = L.size();
+    if(nget > vsize) Error("davidson: more eigenvectors requested than size of the space");
+
+    //Each block iteration adds at most nget
+    //vectors to the basis V
+    auto maxbasis = std::min(nget*(maxiter_+1),vsize);
+    auto V = Mat<T>(vsize,maxbasis);
+    auto AV = Mat<T>(vsize,maxbasis);
+    auto M = Mat<T>(maxbasis,maxbasis);
+    auto c = Vec<T>(maxbasis);
+
+    //Orthonormalize the initial vectors,
+    //doing the same operations on their products
+    auto nv = size_t(0);
+    for(auto j : range(nget))
+        {
+        auto v = column(V,nv);
+        auto Av = column(AV,nv);
+        v &= flatView<T>(phi.at(j),L);
+        Av &= flatView<T>(Aphi.at(j),L);
+        auto cb = subVector(c,0,nv);
+        for(int pass = 1; pass <= 2 && nv > 0; ++pass)
+            {
+            multDag(columns(V,0,nv),v,cb);
+            multSub<T>(columns(V,0,nv),cb,v);
+            multSub<T>(columns(AV,0,nv),cb,Av);
+            }
+        auto nrm = norm(v);
+        while(nrm < 1E-10)
+            {
+            //Initial vector not independent
+            //of the previous ones, randomize it
+            if(debug_level_ >= 2) println("Initial vector not independent, randomizing");
+            randomize(v);
+            if(nv > 0)
+                {
+                multDag(columns(V,0,nv),v,cb);
+                multSub<T>(columns(V,0,nv),cb,v);
+                }
+            nrm = norm(v);
+            if(nrm >= 1E-10)
+                {
+                v *= 1./nrm;
+                nrm = 1.;
+                auto Avn = ITensor{};
+                START_TIMER(21);
+                A.product(toITensor<T>(v,L),Avn);
+                STOP_TIMER(21);
+                Av &= flatView<T>(Avn,L);
+                }
+            }
+        v *= 1./nrm;
+        Av *= 1./nrm;
+        ++nv;
+        }
+
+    //M = dag(V)*A*V, adding the columns
+    //(and rows) for the basis vectors k0,...,k1-1
+    auto Mn = Mat<T>{};
+    auto addToM = [&](size_t k0, size_t k1)
+        {
+        Mn = Mat<T>(k1,k1-k0);
+        multDag(columns(V,0,k1),columns(AV,k0,k1),makeRef(Mn));
+        auto Mref = subMatrix(M,0,k1,0,k1);
+        for(auto k : range(k0,k1))
+            {
+            column(Mref,k) &= column(Mn,k-k0);
+            row(Mref,k) &= conj(column(Mn,k-k0));
+            }
+        };
+    addToM(0,nv);
+
+    Vector D;
+    Mat<T> U;
+
+    auto eigs = std::vector<Real>(nget,NAN);
+    auto last_eigs = std::vector<Real>(nget,1000.);
+    auto qnorms = std::vector<Real>(nget,NAN);
+    Real qnorm = NAN;
+    //Ritz vectors X and residuals R
+    auto X = Mat<T>(vsize,nget);
+    auto R = Mat<T>(vsize,nget);
+    auto Axn = std::vector<ITensor>{};
+    auto xn = std::vector<ITensor>{};
+
+    auto iter = size_t(0);
+    while(true)
+        {
+        //Diagonalize M, giving
+        //the lowest nget Ritz pairs
+        auto Mref = subMatrix(M,0,nv,0,nv);
+        Mref *= -1;
+        diagHermitian(Mref,U,D);
+        Mref *= -1;
+        D *= -1;
+        auto Y = columns(U,0,nget);
+        gemm<T,T>(columns(V,0,nv),Y,makeRef(X),1.,0.);
+        gemm<T,T>(columns(AV,0,nv),Y,makeRef(R),1.,0.);
+
+        //Check convergence of each Ritz pair
+        auto nconv = size_t(0);
+        qnorm = 0.;
+        for(auto j : range(nget))
+            {
+            eigs.at(j) = D(j);
+            axpy(T(-D(j)),column(X,j),column(R,j));
+            //Fix sign
+            if(std::real(U(0,j)) < 0)
+                {
+                column(X,j) *= -1.;
+                column(R,j) *= -1.;
+                }
+            auto& qn = qnorms.at(j);
+            qn = norm(column(R,j));
+            qnorm = std::max(qnorm,qn);
+            bool converged = (qn < errgoal_ && std::abs(D(j)-last_eigs.at(j)) < errgoal_)
+                             || qn < std::max(Approx0,errgoal_ * 1E-3);
+            if(converged) ++nconv;
+            last_eigs.at(j) = D(j);
+            }
+
+        if(debug_level_ >= 2 || (iter == 0 && debug_level_ >= 1))
+            {
+            printf("I %d q %.0E E",iter,qnorm);
+            for(auto eig : eigs) printf(" %.10f",eig);
+            println();
+            }
+
+        if((nconv == nget && iter >= miniter_) || iter == maxiter_ || nv == maxbasis)
+            {
+            if(debug_level_ >= 3)
+                {
+                if(nconv == nget) println("Exiting block Davidson: all eigenvectors converged");
+                else if(iter == maxiter_) println("Exiting block Davidson because iter == maxiter");
+                else println("Exiting block Davidson: max basis size reached");
+                }
+            break;
+            }
+
+        //Expand the basis by the residuals of the
+        //unconverged Ritz vectors (all of them if
+        //still below MinIter), orthogonalized as a
+        //block against V with two passes
+        auto W = columns(V,nv,maxbasis);
+        auto m = size_t(0);
+        for(auto j : range(nget))
+            {
+            if(m == ncols(W)) break;
+            auto qn = qnorms.at(j);
+            if(qn < 1E-20) continue;
+            if(nconv == nget || qn >= std::max(Approx0,errgoal_ * 1E-3))
+                {
+                column(W,m) &= column(R,j);
+                column(W,m) *= 1./qn;
+                ++m;
+                }
+            }
+        if(m == 0) break;
+        auto Wb = columns(W,0,m);
+        auto Cb = Mat<T>(nv,m);
+        for(int pass = 1; pass <= 2; ++pass)
+            {
+            multDag(columns(V,0,nv),Wb,makeRef(Cb));
+            gemm<T,T>(columns(V,0,nv),Cb,Wb,-1.,1.);
+            }
+        //Then within the block, dropping
+        //vectors that are not independent
+        auto nnew = size_t(0);
+        for(auto k : range(m))
+            {
+            auto w = column(V,nv+nnew);
+            if(k != nnew) w &= column(V,nv+k);
+            auto cb = subVector(c,0,nnew);
+            for(int pass = 1; pass <= 2 && nnew > 0; ++pass)
+                {
+                multDag(columns(V,nv,nv+nnew),w,cb);
+                multSub<T>(columns(V,nv,nv+nnew),cb,w);
+                }
+            auto nrm = norm(w);
+            if(nrm < 1E-10) continue;
+            w *= 1./nrm;
+            ++nnew;
+            }
+        if(nnew == 0)
+            {
+            if(debug_level_ >= 3) println("Exiting block Davidson: no independent residuals");
+            break;
+            }
+
+        //Apply A to the new vectors together
+        xn.resize(nnew);
+        for(auto k : range(nnew)) xn[k] = toITensor<T>(column(V,nv+k),L);
+        davidson_details::productBatch(A,xn,Axn);
+        for(auto k : range(nnew)) column(AV,nv+k) &= flatView<T>(Axn.at(k),L);
+
+        //Add the new columns to M
+        addToM(nv,nv+nnew);
+
+        nv += nnew;
+        ++iter;
+        }
+
+    for(auto j : range(nget))
+        {
+        phi.at(j) = toITensor<T>(column(X,j),L);
+        }
+
+    if(debug_level_ > 0)
+        {
+        printf("I %d q %.0E E",iter,qnorm);
+        for(auto eig : eigs) printf(" %.10f",eig);
+        println();
+        }
+
+    return eigs;
+    }
+
+template <class BigMatrixT>
+std::vector<Real>
+davidson(BigMatrixT const& A, 
+         std::vector<ITensor>& phi,
+         Args const& args)
+    {
+    auto debug_level_ = args.getInt("DebugLevel",-1);
+
+    auto nget = phi.size();
+    if(nget == 0) Error("No initial vectors passed to davidson.");
+    for(auto j : range(nget))
+        {
+        auto nrm = norm(phi[j]);
+        while(nrm == 0.0) 
+            {
+            phi[j].randomize();
+            nrm = norm(phi[j]);
+            }
+        phi[j] *= 1./nrm;
+        }
+
+    if(dim(inds(phi.front())) != size_t(A.size()))
+        {
+        println("dim(inds(phi.front())) = ",dim(inds(phi.front())));
+        println("A.size() = ",A.size());
+        Error("davidson: size of initial vector should match linear matrix size");
+        }
+
+    auto method = args.getString("DavidsonMethod","Single");
+    if(method == "Block")
+        {
+        auto Aphi = std::vector<ITensor>{};
+        davidson_details::productBatch(A,phi,Aphi);
+        auto cplx = false;
+        for(auto j : range(nget))
+            {
+            cplx = cplx || isComplex(phi[j]) || isComplex(Aphi.at(j));
+            }
+        if(cplx) return davidsonBlockImpl<Cplx>(A,phi,Aphi,args);
+        return davidsonBlockImpl<Real>(A,phi,Aphi,args);
+        }
+    else if(method != "Single")
+        {
+        Error(format("davidson: DavidsonMethod \"%s\" not recognized",method));
+        }
+
+    //Use the first product to decide whether
+    //to work with real or complex vectors
+    ITensor Aphi0;
+    START_TIMER(21);
+    A.product(phi.front(),Aphi0);
+    STOP_TIMER(21);
+    if(isComplex(phi.front()) || isComplex(Aphi0))
+        {
+        if(debug_level_ > 2)
+            println("Calling complex version of davidsonImpl()");
+        return davidsonImpl<Cplx>(A,phi,Aphi0,args);
+        }
+    if(debug_level_ > 2)
+        println("Calling real version of davidsonImpl()");
+    return davidsonImpl<Real>(A,phi,Aphi0,args);
+    }
+
 namespace gmres_details {
 
 template<class Matrix, class T, class BigVectorT>
@@ -0,0 +1,182 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "itensor/mps/asynctensorio.h"
+#include "itensor/tensorfile.h"
+
+namespace itensor {
+
+AsyncTensorIO::
+AsyncTensorIO(int max_pending)
+    : max_pending_(max_pending < 1 ? 1 : max_pending)
+    {
+    worker_ = std::thread([this]() { workerLoop(); });
+    }
+
+AsyncTensorIO::
+~AsyncTensorIO()
+    {
+        {
+        std::lock_guard<std::mutex> lk(m_);
+        stop_ = true;
+        }
+    cv_.notify_all();
+    worker_.join();
+    }
+
+void AsyncTensorIO::
+checkError()
+    {
+    if(err_)
+        {
+        auto err = err_;
+        err_ = nullptr;
+        std::rethrow_exception(err);
+        }
+    }
+
+void AsyncTensorIO::
+write(std::string const& fname, ITensor const& T)
+    {
+    std::unique_lock<std::mutex> lk(m_);
+    checkError();
+    //Back-pressure: drop prefetched tensors
+    //first, then wait for writes to finish
+    while(held_.size() >= size_t(max_pending_) && !held_.count(fname))
+        {
+        auto dropped = false;
+        for(auto it = held_.begin(); it != held_.end(); ++it)
+            {
+            if(it->second.nwrite == 0 && !it->second.loading)
+                {
+                held_.erase(it);
+                dropped = true;
+                break;
+                }
+            }
+        if(!dropped) cv_.wait(lk);
+        checkError();
+        }
+    auto& E = held_[fname];
+    E.T = T;
+    E.nwrite += 1;
+    jobs_.push_back(Job{true,fname});
+    lk.unlock();
+    cv_.notify_all();
+    }
+
+void AsyncTensorIO::
+prefetch(std::string const& fname)
+    {
+        {
+        std::lock_guard<std::mutex> lk(m_);
+        if(held_.count(fname) 
+           || !on_disk_.count(fname)
+           || held_.size() >= size_t(max_pending_)) return;
+        held_[fname].loading = true;
+        jobs_.push_back(Job{false,fname});
+        }
+    cv_.notify_all();
+    }
+
+void AsyncTensorIO::
+read(std::string const& fname, ITensor & T)
+    {
+        {
+        std::unique_lock<std::mutex> lk(m_);
+        checkError();
+        auto it = held_.find(fname);
+        while(it != held_.end() && it->second.loading)
+            {
+            cv_.wait(lk);
+            checkError();
+            it = held_.find(fname);
+            }
+        if(it != held_.end())
+            {
+            T = it->second.T;
+            //A prefetched copy is only used once
+            if(it->second.nwrite == 0) held_.erase(it);
+            return;
+            }
+        }
+    readFromMappedFile(fname,T);
+    }
+
+void AsyncTensorIO::
+flush()
+    {
+    std::unique_lock<std::mutex> lk(m_);
+    cv_.wait(lk,[this]()
+        {
+        if(err_) return true;
+        if(!jobs_.empty()) return false;
+        for(auto& h : held_) if(h.second.nwrite > 0 || h.second.loading) return false;
+        return true;
+        });
+    checkError();
+    }
+
+void AsyncTensorIO::
+workerLoop()
+    {
+    std::unique_lock<std::mutex> lk(m_);
+    while(true)
+        {
+        cv_.wait(lk,[this]() { return stop_ || !jobs_.empty(); });
+        if(jobs_.empty()) return; //stop_ is set and no work remains
+        auto job = jobs_.front();
+        jobs_.pop_front();
+        auto& E = held_[job.fname];
+        //Copy shares storage with the held tensor,
+        //which is never modified in place
+        auto T = E.T;
+        lk.unlock();
+        try
+            {
+            if(job.write) writeToMappedFile(job.fname,T);
+            else          readFromMappedFile(job.fname,T);
+            }
+        catch(...)
+            {
+            lk.lock();
+            if(!err_) err_ = std::current_exception();
+            auto& F = held_[job.fname];
+            if(job.write) F.nwrite -= 1;
+            else          F.loading = false;
+            if(F.nwrite == 0 && !F.loading) held_.erase(job.fname);
+            cv_.notify_all();
+            continue;
+            }
+        lk.lock();
+        auto& F = held_[job.fname];
+        if(job.write)
+            {
+            on_disk_.insert(job.fname);
+            F.nwrite -= 1;
+            //Once written, the tensor is no longer needed in memory
+            if(F.nwrite == 0) held_.erase(job.fname);
+            }
+        else
+            {
+            F.loading = false;
+            //A write issued after the prefetch holds newer data
+            if(F.nwrite == 0) F.T = std::move(T);
+            }
+        cv_.notify_all();
+        }
+    }
+
+} //namespace itensor
@@ -0,0 +1,111 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_ASYNCTENSORIO_H
+#define __ITENSOR_ASYNCTENSORIO_H
+
+#include <string>
+#include <map>
+#include <set>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include "itensor/itensor.h"
+
+namespace itensor {
+
+//
+// AsyncTensorIO - writes and reads ITensors to and from
+// files (see writeToMappedFile) on a background thread
+//
+// o write(fname,T) returns right away; T is kept in memory
+//   until it has been written, and a read of fname in
+//   the meantime is served from that copy
+// o prefetch(fname) starts reading a previously
+//   written file so that a later read(fname,T)
+//   does not have to wait on the disk
+// o At most maxPending() tensors are held at once
+//   (written or prefetched); when that many are held,
+//   prefetch does nothing and write waits for the
+//   oldest writes to finish
+// o Errors from the background thread are rethrown
+//   by the next call to write, read or flush
+//
+
+class AsyncTensorIO
+    {
+    struct Entry
+        {
+        ITensor T;
+        int nwrite = 0;
+        bool loading = false;
+        };
+    struct Job
+        {
+        bool write = false;
+        std::string fname;
+        };
+
+    int max_pending_ = 4;
+    std::map<std::string,Entry> held_;
+    std::set<std::string> on_disk_;
+    std::deque<Job> jobs_;
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::exception_ptr err_;
+    bool stop_ = false;
+    std::thread worker_;
+    public:
+
+    explicit
+    AsyncTensorIO(int max_pending = 4);
+
+    //Waits for all writes to finish
+    ~AsyncTensorIO();
+
+    AsyncTensorIO(AsyncTensorIO const&) = delete;
+
+    AsyncTensorIO& operator=(AsyncTensorIO const&) = delete;
+
+    int
+    maxPending() const { return max_pending_; }
+
+    void
+    write(std::string const& fname, ITensor const& T);
+
+    void
+    prefetch(std::string const& fname);
+
+    void
+    read(std::string const& fname, ITensor & T);
+
+    //Wait until all queued reads and writes are done
+    void
+    flush();
+
+    private:
+
+    void
+    checkError();
+
+    void
+    workerLoop();
+    };
+
+} //namespace itensor
+
+#endif
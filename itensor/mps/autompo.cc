@@ -15,7 +15,11 @@
 //
 #include <algorithm>
 #include <map>
+#include <unordered_map>
+#include <deque>
+#include <mutex>
 #include "itensor/util/print_macro.h"
+#include "itensor/util/threadpool.h"
 #include "itensor/mps/autompo.h"
 #include "itensor/tensor/algs.h"
 
@@ -72,6 +76,41 @@ isReal(const Cplx& z) { return z.imag() == 0; }
 bool
 isApproxReal(Cplx const& z, Real epsilon = 1E-12) { return std::fabs(z.imag()) < epsilon; }
 
+static std::mutex opNamesMutex;
+
+struct OpNames
+    {
+    std::unordered_map<string,int> ids;
+    std::deque<string> names;
+    };
+
+static OpNames&
+opNames()
+    {
+    static OpNames on;
+    return on;
+    }
+
+int
+opId(string const& opname)
+    {
+    std::lock_guard<std::mutex> lock(opNamesMutex);
+    auto& on = opNames();
+    auto it = on.ids.find(opname);
+    if(it != on.ids.end()) return it->second;
+    auto id = int(on.names.size());
+    on.names.push_back(opname);
+    on.ids.emplace(opname,id);
+    return id;
+    }
+
+string const&
+opName(int id)
+    {
+    std::lock_guard<std::mutex> lock(opNamesMutex);
+    return opNames().names.at(id);
+    }
+
 SiteTerm::
 SiteTerm() : i(-1) { }
 
@@ -80,7 +119,8 @@ SiteTerm(string const& op_,
          int i_)
     :
     op(op_),
-    i(i_)
+    i(i_),
+    id(opId(op_))
     { }
 
 bool
@@ -138,6 +178,49 @@ fermionicTerm(const string& op)
     return op;
     }
 
+//Same as fermionicTerm(st.op) but with the rewritten
+//terms made only once, so that partitionHTerms does
+//not look up op ids (under a lock) from every thread
+SiteTerm
+fermionicTerm(SiteTerm const& st)
+    {
+    static auto const rewrites = []()
+        {
+        auto r = vector<pair<int,SiteTerm>>{};
+        for(auto op : {"Cdagup","Cup","Cdagdn","Cdn","C","Cdag"})
+            {
+            r.emplace_back(opId(op),SiteTerm(fermionicTerm(op),0));
+            }
+        return r;
+        }();
+    for(auto& p : rewrites)
+        {
+        if(p.first != st.id) continue;
+        auto rst = p.second;
+        rst.i = st.i;
+        return rst;
+        }
+    return st;
+    }
+
+SiteTerm
+siteTermF(int i)
+    {
+    static auto const F = SiteTerm("F",0);
+    auto st = F;
+    st.i = i;
+    return st;
+    }
+
+SiteTerm
+siteTermId(int i)
+    {
+    static auto const Id = SiteTerm("Id",0);
+    auto st = Id;
+    st.i = i;
+    return st;
+    }
+
 void 
 rewriteFermionic(SiteTermProd & prod, 
                  bool isleftFermionic)
@@ -155,14 +238,14 @@ rewriteFermionic(SiteTermProd & prod,
     bool isSiteFermionic = isFermionic(prod);
     if(isSiteFermionic)
         {
-        for(auto& st : prod) if(isFermionic(st)) st.op = fermionicTerm(st.op);
+        for(auto& st : prod) if(isFermionic(st)) st = fermionicTerm(st);
         }
     
     // Add a FermiPhase operator at the end if the product of operators
     // to the left (including this site) is fermionic
     if((isleftFermionic && !isSiteFermionic) || (!isleftFermionic && isSiteFermionic))
         {
-        prod.emplace_back("F", i);         
+        prod.push_back(siteTermF(i));
         }
     }
 
@@ -227,8 +310,8 @@ operator==(HTerm const& o) const
     if(not equal(coef,o.coef,1E-12)) return false;
     if(Nops() != o.Nops()) return false;
 
-    for(size_t n = 0; n <= ops.size(); ++n)
-    if(ops[n] != o.ops.at(n)) 
+    for(size_t n = 0; n < ops.size(); ++n)
+    if(ops[n] != o.ops[n]) 
         {
         return false;
         }
@@ -375,17 +458,19 @@ add(HTerm const& t)
     {
     if(abs(t.coef) == 0.0) return;
 
-    auto it = terms_.find(t);
+    auto nt = t;
+    for(auto& st : nt.ops) st.id = opId(st.op);
+
+    auto it = terms_.find(nt);
     if(it == terms_.end())
         {
-        terms_.insert(move(t));
+        terms_.insert(move(nt));
         }
     else //found duplicate
         {
-        auto nt = t;
         nt.coef += it->coef;
-        terms_.erase(it);
-        terms_.insert(move(nt));
+        it = terms_.erase(it);
+        terms_.insert(it,move(nt));
         }
     }
 
@@ -989,55 +1074,42 @@ partitionHTerms(SiteSet const& sites,
     {
     auto N = length(sites);
 
-    // TODO: This version of calcQN uses a "qnmap" to improve
-    //       the speed.
-    //       The qnmap keys are just strings, which assumes
-    //       all operators with the same name have the same
-    //       QN divergence. This wouldn't be true e.g. for
-    //       a spin model with different spin sizes at 
-    //       different sites.
-    //
-    //auto qnmap = map<string,QN>();
-    //auto calcQN = [&qnmap,&sites](SiteTermProd const& prod)
-    //    {
-    //    QN qn;
-    //    for(auto& st : prod)
-    //        {
-    //        auto it = qnmap.find(st.op);
-    //        if(it != qnmap.end())
-    //            {
-    //            qn += it->second;
-    //            }
-    //        else
-    //            {
-    //            auto Op = op(sites,st.op,st.i);
-    //            auto OpQN = -div(Op);
-    //            qnmap[st.op] = OpQN;
-    //            qn += OpQN;
-    //            }
-    //        }
-    //    return qn;
-    //    };
-
-    auto calcQN = [&sites](SiteTermProd const& prod)
+    //QN of each operator of the terms, by site and
+    //op id (the same name can stand for operators with
+    //different QNs on sites of different types)
+    auto opqn = vector<map<int,QN>>(N+1);
+    if(checkqns)
         {
-        QN qn;
-        for(auto& st : prod)
+        for(auto& ht : terms)
+        for(auto& st : ht.ops)
             {
-            auto Op = op(sites,st.op,st.i);
-            //if(not hasQNs(Op)) return QN();
-            auto OpQN = -div(Op);
-            qn += OpQN;
+            auto& q = opqn.at(st.i);
+            if(q.count(st.id) == 0) q[st.id] = -div(op(sites,st.op,st.i));
             }
+        }
+    auto calcQN = [&opqn](SiteTermProd const& prod)
+        {
+        QN qn;
+        for(auto& st : prod) qn += opqn[st.i].at(st.id);
         return qn;
         };
 
     qbs.resize(N);
     tempMPO.resize(N);
 
-    for(HTerm const& ht : terms)
+    //Terms which begin on, end on, or cross each site
+    auto by_site = vector<vector<HTerm const*>>(N+1);
+    for(auto& ht : terms)
     for(int n = ht.first().i; n <= ht.last().i; ++n)
         {
+        by_site.at(n).push_back(&ht);
+        }
+
+    auto addTerms = [&](int n)
+        {
+        for(auto pt : by_site[n])
+        {
+        auto& ht = *pt;
         SiteTermProd left, onsite, right;
         decomposeTerm(n, ht.ops, left, onsite, right);
         
@@ -1083,8 +1155,8 @@ partitionHTerms(SiteSet const& sites,
         bool leftF = isFermionic(left);
         if(onsite.empty())
             {
-            if(leftF) onsite.emplace_back("F",n);
-            else      onsite.emplace_back("Id",n);
+            if(leftF) onsite.push_back(siteTermF(n));
+            else      onsite.push_back(siteTermId(n));
             }
         else
             {
@@ -1115,6 +1187,24 @@ partitionHTerms(SiteSet const& sites,
         if(it == tn.end()) tn.insert(move(el));
 
         }
+        };
+
+    //Site n changes only the blocks of links n-2 and n-1
+    //and tempMPO.at(n-1), so all odd sites and then all
+    //even sites can be done in parallel
+    auto& pool = threadPool();
+    for(auto parity : {1,0})
+        {
+        auto ns = vector<int>{};
+        auto costs = vector<double>{};
+        for(auto n : range1(N))
+            {
+            if(n%2 != parity) continue;
+            ns.push_back(n);
+            costs.push_back(by_site[n].size());
+            }
+        parallelFor(pool,costs,pool.nthread(),[&ns,&addTerms](size_t k) { addTerms(ns[k]); });
+        }
     }
 
 
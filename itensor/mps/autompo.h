@@ -52,10 +52,29 @@ toExpH(AutoMPO const& a,
 
 
 
+//
+// Operator names of AutoMPO terms are interned: each
+// distinct name gets an integer id (in order of first
+// use), so that the QN and fermionic form of each
+// operator can be looked up by id when making the MPO
+//
+int
+opId(std::string const& opname);
+
+std::string const&
+opName(int id);
+
+//
+// Operator op on site i. id is the interned id of op
+// (see opId), set by the constructor. AutoMPO::add sets
+// it again from op, so terms made by assigning op
+// directly are still merged and partitioned correctly.
+//
 struct SiteTerm
     {
     std::string op;
     int i;
+    int id = -1;
 
     SiteTerm();
 
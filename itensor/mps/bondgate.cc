@@ -0,0 +1,219 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <cmath>
+#include <mutex>
+#include <functional>
+#include "itensor/mps/bondgate.h"
+#include "itensor/decomp.h"
+#include "itensor/util/lrucache.h"
+
+namespace itensor {
+
+//
+// Cache of gates keyed on a hash of (type, tau, bondH);
+// since hashes can collide each entry also keeps tau and
+// bondH, which are compared exactly before a gate is reused
+//
+
+struct GateCacheEntry
+    {
+    BondGate::Type type = BondGate::tReal;
+    Real tau = 0.;
+    ITensor H;
+    ITensor gate;
+    };
+
+static std::mutex&
+gateCacheMutex()
+    {
+    static std::mutex m;
+    return m;
+    }
+
+static LRUCache<size_t,GateCacheEntry>&
+gateCache()
+    {
+    static LRUCache<size_t,GateCacheEntry> cache(256);
+    return cache;
+    }
+
+static CacheCounters&
+gateCacheCounters()
+    {
+    static CacheCounters c;
+    return c;
+    }
+
+CacheStats
+bondGateCacheStats() { return CacheStats(gateCacheCounters()); }
+
+void
+clearBondGateCache()
+    {
+    std::lock_guard<std::mutex> lk(gateCacheMutex());
+    gateCache().clear();
+    gateCacheCounters().hits = 0;
+    gateCacheCounters().misses = 0;
+    }
+
+static void
+hashCombine(size_t & h, size_t v)
+    {
+    h ^= v + 0x9e3779b97f4a7c15ul + (h << 6) + (h >> 2);
+    }
+
+static size_t
+gateKey(BondGate::Type type,
+        Real tau,
+        ITensor const& H)
+    {
+    size_t h = std::hash<int>{}(int(type));
+    hashCombine(h,std::hash<Real>{}(tau));
+    for(auto& i : inds(H))
+        {
+        hashCombine(h,std::hash<Index::id_type>{}(i.id()));
+        hashCombine(h,std::hash<int>{}(i.primeLevel()));
+        }
+    auto hashEl = [&h](Cplx z)
+        {
+        hashCombine(h,std::hash<Real>{}(z.real()));
+        hashCombine(h,std::hash<Real>{}(z.imag()));
+        };
+    H.visit(hashEl);
+    return h;
+    }
+
+//Operator product A*B: A acting after B,
+//both with index pairs s,s'
+static ITensor
+opProduct(ITensor A,
+          ITensor const& B)
+    {
+    A.prime();
+    A *= B;
+    A.replaceTags("2","1");
+    return A;
+    }
+
+//exp(t*H) by scaling and squaring: for ||t*H/2^s|| <= 1/2
+//a Taylor series of degree 13 is accurate to double
+//precision, and squaring s times undoes the scaling
+static ITensor
+expScaledTaylor(ITensor const& H,
+                Cplx t,
+                ITensor const& unit)
+    {
+    auto X = t.imag() == 0. ? t.real()*H : t*H;
+    auto nrm = norm(X);
+    int s = 0;
+    if(nrm > 0.5) s = int(std::ceil(std::log2(nrm/0.5)));
+    X /= std::pow(2.,s);
+    //exp(x) ~ ((x/13 + 1) * x/12 + 1) * ... * x + 1
+    auto term = X;
+    ITensor gate;
+    for(int ord = 13; ord >= 1; --ord)
+        {
+        term /= ord;
+        gate = unit + term;
+        if(ord > 1) term = opProduct(gate,X);
+        }
+    for(int n = 0; n < s; ++n)
+        {
+        gate = opProduct(gate,gate);
+        }
+    return gate;
+    }
+
+//exp(t*H) for Hermitian H from its eigendecomposition
+//(diagHermitian works block by block for QN conserving H)
+static ITensor
+expHermitianExact(ITensor const& H,
+                  Cplx t)
+    {
+    ITensor U,d;
+    diagHermitian(H,U,d,{"Truncate=",false});
+    if(t.imag() == 0.)
+        {
+        auto tr = t.real();
+        d.apply([tr](Real x) { return std::exp(tr*x); });
+        }
+    else
+        {
+        d.apply([t](Real x) { return std::exp(t*x); });
+        }
+    return prime(U)*d*dag(U);
+    }
+
+BondGate::
+BondGate(SiteSet const& sites, 
+         int i1, 
+         int i2, 
+         Type type, 
+         Real tau, 
+         ITensor bondH)
+  : type_(type)
+    {
+    if(i1 < i2)
+        {
+        i1_ = i1;
+        i2_ = i2;
+        }
+    else
+        {
+        i1_ = i2;
+        i2_ = i1;
+        }
+
+    if(!(type_ == tReal || type_ ==tImag))
+        {
+        Error("When providing bondH, type must be tReal or tImag");
+        }
+
+    auto key = gateKey(type_,tau,bondH);
+        {
+        std::lock_guard<std::mutex> lk(gateCacheMutex());
+        auto* e = gateCache().find(key);
+        if(e && e->type == type_ && e->tau == tau 
+           && hasSameInds(inds(e->H),inds(bondH))
+           && norm(e->H-bondH) == 0.)
+            {
+            ++gateCacheCounters().hits;
+            gate_ = e->gate;
+            return;
+            }
+        }
+    ++gateCacheCounters().misses;
+
+    auto t = (type_ == tReal) ? Cplx(0.,-tau) : Cplx(-tau,0.);
+    auto nrm = norm(bondH);
+    if(nrm == 0.)
+        {
+        gate_ = sites.op("Id",i1_)*sites.op("Id",i2_);
+        }
+    else if(norm(bondH-swapPrime(dag(bondH),0,1)) <= 1E-12*nrm)
+        {
+        gate_ = expHermitianExact(bondH,t);
+        }
+    else
+        {
+        gate_ = expScaledTaylor(bondH,t,sites.op("Id",i1_)*sites.op("Id",i2_));
+        }
+
+    std::lock_guard<std::mutex> lk(gateCacheMutex());
+    gateCache().insert(key,GateCacheEntry{type_,tau,bondH,gate_});
+    }
+
+} //namespace itensor
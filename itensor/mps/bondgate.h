@@ -18,6 +18,7 @@
 
 #include "itensor/itensor.h"
 #include "itensor/mps/siteset.h"
+#include "itensor/util/lrucache.h"
 
 namespace itensor {
 
@@ -34,6 +35,15 @@ class BondGate
              int i1, 
              int i2);
 
+    //
+    // Gate exp(-tau*bondH) (tImag) or exp(-i*tau*bondH) (tReal).
+    // A Hermitian bondH is exponentiated through its
+    // eigendecomposition (block by block if it conserves QNs),
+    // any other bondH by scaling and squaring.
+    // Recently made gates are cached by (type, tau, bondH),
+    // so building the same gates again for each time step
+    // reuses them.
+    //
     BondGate(SiteSet const& sites, 
              int i1, 
              int i2, 
@@ -68,6 +78,16 @@ class BondGate
     makeSwapGate(SiteSet const& sites);
     };
 
+//
+// Hits and misses of the cache of gates made
+// from bond Hamiltonians, and a way to empty it
+//
+CacheStats
+bondGateCacheStats();
+
+void
+clearBondGateCache();
+
 ITensor inline
 operator*(BondGate const& G, ITensor T) { T *= G.gate(); return T; }
 
@@ -93,52 +113,6 @@ BondGate(SiteSet const& sites,
     makeSwapGate(sites);
     }
 
-inline BondGate::
-BondGate(SiteSet const& sites, 
-         int i1, 
-         int i2, 
-         Type type, 
-         Real tau, 
-         ITensor bondH)
-  : type_(type)
-    {
-    if(i1 < i2)
-        {
-        i1_ = i1;
-        i2_ = i2;
-        }
-    else
-        {
-        i1_ = i2;
-        i2_ = i1;
-        }
-
-    if(!(type_ == tReal || type_ ==tImag))
-        {
-        Error("When providing bondH, type must be tReal or tImag");
-        }
-    bondH *= -tau;
-    ITensor unit = sites.op("Id",i1_)*sites.op("Id",i2_);
-    if(type_ == tReal)
-        {
-        bondH *= Complex_i;
-        }
-    auto term = bondH;
-    bondH.replaceTags("1","2");
-    bondH.replaceTags("0","1");
-
-    // exp(x) = 1 + x +  x^2/2! + x^3/3! ..
-    // = 1 + x * (1 + x/2 *(1 + x/3 * (...
-    // ~ ((x/3 + 1) * x/2 + 1) * x + 1
-    for(int ord = 100; ord >= 1; --ord)
-        {
-        term /= ord;
-        gate_ = unit + term;
-        term = gate_ * bondH;
-        term.replaceTags("2","1");
-        }
-    }
-
 inline BondGate::
 BondGate(SiteSet const& sites, 
          int i1, 
@@ -15,8 +15,11 @@
 //
 #ifndef __ITENSOR_LOCALMPO
 #define __ITENSOR_LOCALMPO
+#include <memory>
 #include "itensor/mps/mpo.h"
 #include "itensor/mps/localop.h"
+#include "itensor/mps/asynctensorio.h"
+#include "itensor/tensorfile.h"
 #include "itensor/util/print_macro.h"
 
 namespace itensor {
@@ -105,6 +108,10 @@ class LocalMPO
 
     void
     product(const ITensor& phi, ITensor& phip) const;
+
+    void
+    productBatch(std::vector<ITensor> const& phi,
+                 std::vector<ITensor> & phip) const;
     
     void
     productnext(const ITensor& phi, ITensor& phip, Direction dir) const;
@@ -198,6 +205,17 @@ class LocalMPO
 
     explicit operator bool() const { return Op_ != 0 || Psi_ != 0; }
 
+    //
+    // doWrite(true,args) keeps only the edge tensors
+    // in use in memory, writing the others to
+    // files in a temporary directory in "WriteDir".
+    // Unless "WriteAsync" is false, files are written
+    // and read on a background thread, which also
+    // prefetches the next "WritePrefetch" (default 2)
+    // edge tensors in the direction position is moving.
+    // At most "WriteMaxPending" (default 4) tensors
+    // wait to be written or are prefetched at a time.
+    //
     bool
     doWrite() const { return do_write_; }
     void
@@ -237,6 +255,9 @@ class LocalMPO
 
     bool do_write_ = false;
     std::string writedir_ = "./";
+    std::shared_ptr<AsyncTensorIO> io_;
+    int prefetch_ = 2;
+    int lastpos_ = -1;
 
     const MPS* Psi_;
 
@@ -258,6 +279,9 @@ class LocalMPO
     void
     initWrite(Args const& args);
 
+    void
+    prefetchEdges(int b);
+
     std::string
     PHFName(int j) const
         {
@@ -400,6 +424,21 @@ product(ITensor const& phi,
         }
     }
 
+void inline LocalMPO::
+productBatch(std::vector<ITensor> const& phi,
+             std::vector<ITensor> & phip) const
+    {
+    if(Op_ != 0)
+        {
+        lop_.productBatch(phi,phip);
+        }
+    else
+        {
+        phip.resize(phi.size());
+        for(auto n : range(phi.size())) product(phi[n],phip[n]);
+        }
+    }
+
 void inline LocalMPO::
 productnext(ITensor const& phi,
             ITensor& phip, Direction dir) const
@@ -497,6 +536,8 @@ position(int b, MPS const& psi)
         {
         lop_.update(Op_->A(b),L(),R());
         }
+
+    if(do_write_ && io_) prefetchEdges(b);
     }
 
 int inline LocalMPO::
@@ -650,7 +691,8 @@ setLHlim(int val)
 
     if(LHlim_ != val && PH_.at(LHlim_))
         {
-        writeToFile(PHFName(LHlim_),PH_.at(LHlim_));
+        if(io_) io_->write(PHFName(LHlim_),PH_.at(LHlim_));
+        else    writeToMappedFile(PHFName(LHlim_),PH_.at(LHlim_));
         PH_.at(LHlim_) = ITensor();
         }
     LHlim_ = val;
@@ -663,7 +705,8 @@ setLHlim(int val)
     if(!PH_.at(LHlim_))
         {
         std::string fname = PHFName(LHlim_);
-        readFromFile(fname,PH_.at(LHlim_));
+        if(io_) io_->read(fname,PH_.at(LHlim_));
+        else    readFromMappedFile(fname,PH_.at(LHlim_));
         }
     }
 
@@ -678,7 +721,8 @@ setRHlim(int val)
 
     if(RHlim_ != val && PH_.at(RHlim_))
         {
-        writeToFile(PHFName(RHlim_),PH_.at(RHlim_));
+        if(io_) io_->write(PHFName(RHlim_),PH_.at(RHlim_));
+        else    writeToMappedFile(PHFName(RHlim_),PH_.at(RHlim_));
         PH_.at(RHlim_) = ITensor();
         }
     RHlim_ = val;
@@ -691,7 +735,8 @@ setRHlim(int val)
     if(!PH_.at(RHlim_))
         {
         std::string fname = PHFName(RHlim_);
-        readFromFile(fname,PH_.at(RHlim_));
+        if(io_) io_->read(fname,PH_.at(RHlim_));
+        else    readFromMappedFile(fname,PH_.at(RHlim_));
         }
     }
 
@@ -700,6 +745,37 @@ initWrite(Args const& args)
     {
     auto basedir = args.getString("WriteDir","./");
     writedir_ = mkTempDir("PH",basedir);
+    prefetch_ = args.getInt("WritePrefetch",2);
+    if(args.getBool("WriteAsync",true))
+        {
+        io_ = std::make_shared<AsyncTensorIO>(args.getInt("WriteMaxPending",4));
+        }
+    }
+
+//
+// Moving left, the next edge tensors read back
+// from disk are L's at LHlim_-1, LHlim_-2, ...;
+// moving right they are R's at RHlim_+1, ...
+//
+void inline LocalMPO::
+prefetchEdges(int b)
+    {
+    auto N = Op_->length();
+    if(lastpos_ > b)
+        {
+        for(auto j = LHlim_-1; j >= std::max(1,LHlim_-prefetch_); --j)
+            {
+            io_->prefetch(PHFName(j));
+            }
+        }
+    else if(lastpos_ >= 0 && lastpos_ < b)
+        {
+        for(auto j = RHlim_+1; j <= std::min(N,RHlim_+prefetch_); ++j)
+            {
+            io_->prefetch(PHFName(j));
+            }
+        }
+    lastpos_ = b;
     }
 
 } //namespace itensor
@@ -56,6 +56,10 @@ class LocalMPO_MPS
     product(ITensor const& phi,
             ITensor& phip) const;
 
+    void
+    productBatch(std::vector<ITensor> const& phi,
+                 std::vector<ITensor> & phip) const;
+
     void
     productnext(ITensor const& phi, 
                 ITensor& phip, Direction dir) const { lmpo_.productnext(phi,phip,dir); }
@@ -158,6 +162,22 @@ product(ITensor const& phi,
         }
     }
 
+void inline LocalMPO_MPS::
+productBatch(std::vector<ITensor> const& phi,
+             std::vector<ITensor> & phip) const
+    {
+    lmpo_.productBatch(phi,phip);
+
+    ITensor outer;
+    for(auto& M : lmps_)
+    for(auto n : range(phi.size()))
+        {
+        M.product(phi[n],outer);
+        outer *= weight_;
+        phip[n] += outer;
+        }
+    }
+
 void inline LocalMPO_MPS::
 position(int b, const MPS& psi)
     {
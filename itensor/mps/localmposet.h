@@ -41,6 +41,10 @@ class LocalMPOSet
     product(ITensor const& phi,
             ITensor & phip) const;
 
+    void
+    productBatch(std::vector<ITensor> const& phi,
+                 std::vector<ITensor> & phip) const;
+
     void
     productnext(ITensor const& phi,
                 ITensor & phip, Direction dir) const;
@@ -165,6 +169,20 @@ product(ITensor const& phi,
         }
     }
 
+void inline LocalMPOSet::
+productBatch(std::vector<ITensor> const& phi,
+             std::vector<ITensor> & phip) const
+    {
+    lmpo_.front().productBatch(phi,phip);
+
+    auto phi_n = std::vector<ITensor>{};
+    for(auto n : range(1,lmpo_.size()))
+        {
+        lmpo_[n].productBatch(phi,phi_n);
+        for(auto k : range(phip.size())) phip[k] += phi_n[k];
+        }
+    }
+
 void inline LocalMPOSet::
 productnext(ITensor const& phi,
             ITensor & phip, Direction dir) const
@@ -16,6 +16,7 @@
 #ifndef __ITENSOR_LOCAL_OP
 #define __ITENSOR_LOCAL_OP
 #include "itensor/itensor.h"
+#include "itensor/flatvector.h"
 //#include "itensor/util/print_macro.h"
 
 namespace itensor {
@@ -81,6 +82,17 @@ class LocalOp
 
     void
     product(ITensor const& phi, ITensor & phip) const;
+
+    //phip[n] = product of phi[n] for each n.
+    //Small QN tensors (which must all have the same
+    //indices and flux) are stacked along an extra
+    //index so that L, Op1, Op2 and R are each
+    //contracted only once, saving the overhead
+    //of the many small block contractions.
+    //Otherwise this just calls product for each n.
+    void
+    productBatch(std::vector<ITensor> const& phi,
+                 std::vector<ITensor> & phip) const;
     
     void
     productnext(ITensor const& phi, ITensor & phip, ITensor const& lr, Direction dir) const;
@@ -316,6 +328,33 @@ product(ITensor const& phi,
     phip.replaceTags("1","0");
     }
 
+void inline LocalOp::
+productBatch(std::vector<ITensor> const& phi,
+             std::vector<ITensor> & phip) const
+    {
+    if(!(*this)) Error("LocalOp is null");
+
+    //Beyond this many elements per vector (or for
+    //dense tensors, already contracted as single
+    //large gemm's) stacking was measured to be
+    //slower, enlarging the working set without
+    //saving much overhead
+    const size_t max_stack_size = 8192;
+    if(phi.size() <= 1 
+       || !hasQNs(phi.front()) 
+       || FlatLayout(phi.front()).size() > max_stack_size)
+        {
+        phip.resize(phi.size());
+        for(auto n : range(phi.size())) product(phi[n],phip[n]);
+        return;
+        }
+
+    auto B = Index(QN(),long(phi.size()),"Batch");
+    ITensor bphip;
+    product(stack(phi,B),bphip);
+    phip = unstack(bphip,B);
+    }
+
 void inline LocalOp::
 productnext(ITensor const& phi,
             ITensor      & phip,
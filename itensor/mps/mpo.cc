@@ -17,6 +17,7 @@
 #include "itensor/util/str.h"
 #include "itensor/mps/mpo.h"
 #include "itensor/mps/localop.h"
+#include "itensor/contractsequence.h"
 
 namespace itensor {
 
@@ -630,7 +631,7 @@ inner(MPS const& x,
     //L *= (A(0) ? A(0)*A(1) : A(1));
 
     for( auto n : range1(2,N) ) 
-        L = L * y(n) * A(n) * xdag(n); 
+        L = contractSequence({L,y(n),A(n),xdag(n)});
 
     // TODO: some MPOs may store edge tensors
     // in A(0) and A(N+1). Add this back?
@@ -685,14 +686,14 @@ inner(MPO const& A,
   xdag.replaceLinkInds(sim(linkInds(xdag)));
 
   //scales as m^2 k^2 d
-  auto L = y(1) * B(1) * Adag(1) * xdag(1);
+  auto L = contractSequence({y(1),B(1),Adag(1),xdag(1)});
   for(int i = 2; i < N; i++)
       {
       //scales as m^3 k^2 d + m^2 k^3 d^2
-      L = L * y(i) * B(i) * Adag(i) * xdag(i);
+      L = contractSequence({L,y(i),B(i),Adag(i),xdag(i)});
       }
   //scales as m^2 k^2 d
-  L = L * y(N) * B(N) * Adag(N) * xdag(N);
+  L = contractSequence({L,y(N),B(N),Adag(N),xdag(N)});
   auto z = eltC(L);
   re = real(z);
   im = imag(z);
@@ -745,14 +746,14 @@ inner(MPS const& x,
     xdag.replaceLinkInds(sim(linkInds(xdag)));
 
     //scales as m^2 k^2 d
-    auto L = y(1) * B(1) * Ap(1) * xdag(1);
+    auto L = contractSequence({y(1),B(1),Ap(1),xdag(1)});
     for(int i = 2; i < N; i++)
         {
         //scales as m^3 k^2 d + m^2 k^3 d^2
-        L = L * y(i) * B(i) * Ap(i) * xdag(i);
+        L = contractSequence({L,y(i),B(i),Ap(i),xdag(i)});
         }
     //scales as m^2 k^2 d
-    L = L * y(N) * B(N) * Ap(N) * xdag(N);
+    L = contractSequence({L,y(N),B(N),Ap(N),xdag(N)});
     auto z = eltC(L);
     re = real(z);
     im = imag(z);
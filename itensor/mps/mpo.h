@@ -493,11 +493,25 @@ nmultMPO(MPO const& A,
 //is at most the product of the bond dimension of K
 //and the bond dimension of x. The result can 
 //be controllably truncated further by providing
-//optional truncation args "Cutoff" and "MaxDim"
+//optional truncation args "Cutoff" and "MaxDim".
+//If "MaxMemory" (in MB) is given and the left environment
+//tensors would take more than that, only every ~sqrt(N)'th
+//one is stored (on disk in "WriteDir" if even those do not
+//fit) and the rest are recomputed when needed. With
+//"Verbose" the peak memory used by environments is printed.
+//
+//{"Method=","ZipUp"}:
+//Applies an MPO K to an MPS x in a single pass from left
+//to right, factorizing (and truncating, with a cutoff 10x
+//smaller than "Cutoff") the product site by site, then
+//truncates optimally with "Cutoff" and "MaxDim" on a
+//pass back to the left. Much cheaper than "DensityMatrix"
+//at large bond dimension, with slightly larger errors.
 //
 //{"Method=","Fit"}
 //Applies an MPO K to an MPS psi (|res>=K|psi>) using a sweeping/DMRG-like
-//fitting approach. Warning: this method can get stuck i.e. fail to converge
+//fitting approach, starting from the "ZipUp" result (or
+//from x0 if given). Warning: this method can get stuck i.e. fail to converge
 //if the initial value of res is too different from the product K|psi>.
 //List of options recognized:
 //   Normalize (default: true) - normalize state to 1 after applying MPO
@@ -13,9 +13,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
+#include <map>
 #include "itensor/util/print_macro.h"
 #include "itensor/mps/mpo.h"
 #include "itensor/mps/localop.h"
+#include "itensor/tensorfile.h"
+#include "itensor/contractsequence.h"
+#include "itensor/itdata/applyfunc.h"
 
 namespace itensor {
 
@@ -125,6 +129,11 @@ fitApplyMPOImpl(MPS const& psi,
                 MPS & res,
                 Args const& args = Args::global());
 
+MPS
+zipUpApplyMPOImpl(MPO const& K,
+                  MPS const& x,
+                  Args args = Args::global());
+
 MPS
 applyMPO(MPO const& K,
          MPS const& x,
@@ -141,20 +150,20 @@ applyMPO(MPO const& K,
         {
         res = densityMatrixApplyMPOImpl(K,x,args);
         }
+    else if(method == "ZipUp")
+        {
+        res = zipUpApplyMPOImpl(K,x,args);
+        }
     else if(method == "Fit")
         {
-        // Use the input MPS x to be applied as the
-        // default starting state
-        // TODO: consider using zipUpApplyMPOImpl as 
-        // a way to get a better starting state
-        auto sites = uniqueSiteInds(K,x);
-        res = replaceSiteInds(x,sites);
-        //res = x;
+        // Use the zip-up result as the starting state,
+        // which is much closer to K|x> than x itself
+        res = zipUpApplyMPOImpl(K,x,args);
         fitApplyMPOImpl(x,K,res,args);
         }
     else
         {
-        Error("applyMPO currently supports the following methods: 'DensityMatrix', 'Fit'");
+        Error("applyMPO currently supports the following methods: 'DensityMatrix', 'ZipUp', 'Fit'");
         }
 
     return res;
@@ -177,10 +186,12 @@ applyMPO(MPO const& K,
     MPS res = x0;
     if(method == "DensityMatrix")
         Error("applyMPO method 'DensityMatrix' does not accept an input MPS");
+    else if(method == "ZipUp")
+        Error("applyMPO method 'ZipUp' does not accept an input MPS");
     else if(method == "Fit")
         fitApplyMPOImpl(x,K,res,args);
     else
-        Error("applyMPO currently supports the following methods: 'DensityMatrix', 'Fit'");
+        Error("applyMPO currently supports the following methods: 'DensityMatrix', 'ZipUp', 'Fit'");
 
     return res;
     }
@@ -189,6 +200,240 @@ applyMPO(MPO const& K,
 // Implement specific applyMPO methods
 //
 
+struct StoreBytes
+    {
+    size_t bytes = 0;
+
+    template<typename V>
+    void
+    operator()(Dense<V> const& d) { bytes = d.size()*sizeof(V); }
+
+    template<typename V>
+    void
+    operator()(QDense<V> const& d) { bytes = d.size()*sizeof(V); }
+
+    template<typename D>
+    void
+    operator()(D const& d) { }
+    };
+
+size_t
+storeBytes(ITensor const& T)
+    {
+    auto b = StoreBytes{};
+    if(T.store()) applyFunc(b,T.store());
+    return b.bytes;
+    }
+
+//
+// Number of elements of an environment tensor with
+// links l, w of the ket side and their conjugates:
+// with QNs, only blocks whose charges on the two
+// sides agree are stored
+//
+double
+envSize(Index const& l, Index const& w)
+    {
+    if(!hasQNs(l))
+        {
+        auto d = double(dim(l))*(w ? dim(w) : 1);
+        return d*d;
+        }
+    auto qd = std::map<QN,double>{};
+    for(auto a : range1(nblock(l)))
+        {
+        auto qa = qn(l,a)*dir(l);
+        if(!w)
+            {
+            qd[qa] += blocksize(l,a);
+            continue;
+            }
+        for(auto b : range1(nblock(w)))
+            {
+            qd[qa+qn(w,b)*dir(w)] += double(blocksize(l,a))*blocksize(w,b);
+            }
+        }
+    auto size = 0.;
+    for(auto& q : qd) size += q.second*q.second;
+    return size;
+    }
+
+//
+// Left environments E(j) = E(j-1)*psi(j)*K(j)*Kc(j)*psic(j),
+// j = 1,...,N-1, of densityMatrixApplyMPOImpl,
+// which uses them in the order j = N-1,...,1.
+//
+// If all of them are estimated to take more than
+// maxmem bytes, only every k'th one (k ~ sqrt(N))
+// is kept as a checkpoint and the others are
+// recomputed from the checkpoint below them when
+// needed, which costs at most one more pass over
+// the MPS. If even the checkpoints do not fit they
+// are written to files in a temporary directory
+// in writedir.
+//
+class DMEnvirons
+    {
+    MPS const& psi_;
+    MPO const& K_;
+    MPO const& Kc_;
+    MPS const& psic_;
+    int N_ = 0;
+    int stride_ = 1;
+    bool to_disk_ = false;
+    std::string dir_;
+    std::vector<ITensor> E_;
+    size_t bytes_ = 0,
+           peak_ = 0;
+    public:
+
+    DMEnvirons(MPS const& psi,
+               MPO const& K,
+               MPO const& Kc,
+               MPS const& psic,
+               double maxmem,
+               std::string const& writedir);
+
+    ~DMEnvirons()
+        {
+        if(to_disk_) rmTempDir(dir_);
+        }
+
+    DMEnvirons(DMEnvirons const&) = delete;
+
+    DMEnvirons&
+    operator=(DMEnvirons const&) = delete;
+
+    ITensor const&
+    operator()(int j);
+
+    void
+    release(int j)
+        {
+        bytes_ -= storeBytes(E_.at(j));
+        E_[j] = ITensor();
+        }
+
+    int
+    stride() const { return stride_; }
+
+    bool
+    onDisk() const { return to_disk_; }
+
+    size_t
+    peakBytes() const { return peak_; }
+
+    private:
+
+    bool
+    isCheckpoint(int j) const { return (j-1)%stride_ == 0; }
+
+    ITensor
+    next(ITensor const& E, int j) const
+        {
+        if(!E) return contractSequence({psi_(j),K_(j),Kc_(j),psic_(j)});
+        return contractSequence({E,psi_(j),K_(j),Kc_(j),psic_(j)});
+        }
+
+    void
+    hold(int j, ITensor T)
+        {
+        bytes_ += storeBytes(T);
+        peak_ = std::max(peak_,bytes_);
+        E_.at(j) = std::move(T);
+        }
+
+    std::string
+    fname(int j) const { return format("%s/E_%03d",dir_,j); }
+    };
+
+DMEnvirons::
+DMEnvirons(MPS const& psi,
+           MPO const& K,
+           MPO const& Kc,
+           MPS const& psic,
+           double maxmem,
+           std::string const& writedir)
+  : psi_(psi),
+    K_(K),
+    Kc_(Kc),
+    psic_(psic),
+    N_(length(psi)),
+    E_(N_+1)
+    {
+    if(maxmem > 0)
+        {
+        auto elsize = (isComplex(psi) || isComplex(K)) ? sizeof(Cplx) : sizeof(Real);
+        auto esize = std::vector<double>(N_,0.);
+        auto total = 0.;
+        for(auto j : range1(N_-1))
+            {
+            esize[j] = elsize*envSize(linkIndex(psi,j),commonIndex(K(j),K(j+1)));
+            total += esize[j];
+            }
+        if(total > maxmem)
+            {
+            stride_ = int(std::ceil(std::sqrt(double(N_-1))));
+            auto ckpt = 0.,
+                 seg = 0.,
+                 maxseg = 0.;
+            for(auto j : range1(N_-1))
+                {
+                if(isCheckpoint(j))
+                    {
+                    ckpt += esize[j];
+                    seg = 0.;
+                    }
+                else
+                    {
+                    seg += esize[j];
+                    maxseg = std::max(maxseg,seg);
+                    }
+                }
+            if(ckpt+maxseg > maxmem)
+                {
+                to_disk_ = true;
+                dir_ = mkTempDir("applyMPO",writedir);
+                }
+            }
+        }
+
+    auto E = ITensor{};
+    for(auto j : range1(N_-1))
+        {
+        E = next(E,j);
+        if(stride_ == 1)
+            {
+            hold(j,E);
+            }
+        else if(isCheckpoint(j))
+            {
+            if(to_disk_)
+                {
+                peak_ = std::max(peak_,bytes_+storeBytes(E));
+                writeToMappedFile(fname(j),E);
+                }
+            else
+                {
+                hold(j,E);
+                }
+            }
+        }
+    }
+
+ITensor const& DMEnvirons::
+operator()(int j)
+    {
+    if(E_.at(j) || j < 1) return E_[j];
+    auto c = 1+((j-1)/stride_)*stride_;
+    if(!E_.at(c)) hold(c,readFromMappedFile(fname(c)));
+    for(auto i = c+1; i <= j; ++i)
+        {
+        hold(i,next(E_[i-1],i));
+        }
+    return E_[j];
+    }
+
 
 MPS
 densityMatrixApplyMPOImpl(MPO const& K,
@@ -241,18 +486,20 @@ densityMatrixApplyMPOImpl(MPO const& K,
 
     //Build environment tensors from the left
     if(verbose) print("Building environment tensors...");
-    auto E = std::vector<ITensor>(N+1);
-    E[1] = psi(1)*K(1)*Kc(1)*psic(1);
-    for(int j = 2; j < N; ++j)
+    auto E = DMEnvirons(psi,K,Kc,psic,
+                        args.getReal("MaxMemory",0.)*1E6,
+                        args.getString("WriteDir","./"));
+    if(verbose) println("done");
+    if(verbose && E.stride() > 1)
         {
-        E[j] = E[j-1]*psi(j)*K(j)*Kc(j)*psic(j);
+        printfln("  Keeping every %d'th environment%s",E.stride(),E.onDisk() ? " on disk" : "");
         }
-    if(verbose) println("done");
 
     //O is the representation of the product of K*psi in the new MPS basis
     auto O = psi(N)*K(N);
 
-    auto rho = E[N-1] * O * dag(prime(O,rand_plev));
+    auto rho = contractSequence({E(N-1),O,dag(prime(O,rand_plev))});
+    E.release(N-1);
 
     ITensor U,D;
     auto ts = tags(linkIndex(psi,N-1));
@@ -261,7 +508,7 @@ densityMatrixApplyMPOImpl(MPO const& K,
 
     res.ref(N) = dag(U);
 
-    O = O*U*psi(N-1)*K(N-1);
+    O = contractSequence({O,U,psi(N-1),K(N-1)});
 
     for(int j = N-1; j > 1; --j)
         {
@@ -270,20 +517,23 @@ densityMatrixApplyMPOImpl(MPO const& K,
             //Infer maxdim from bond dim of original MPS
             //times bond dim of MPO
             //i.e. upper bound on order of rho
-            auto cip = commonIndex(psi(j),E[j-1]);
-            auto ciw = commonIndex(K(j),E[j-1]);
+            auto cip = commonIndex(psi(j),E(j-1));
+            auto ciw = commonIndex(K(j),E(j-1));
             auto maxdim = (cip) ? dim(cip) : 1l;
             maxdim *= (ciw) ? dim(ciw) : 1l;
             dargs.add("MaxDim",maxdim);
             }
-        rho = E[j-1] * O * dag(prime(O,rand_plev));
+        rho = contractSequence({E(j-1),O,dag(prime(O,rand_plev))});
+        E.release(j-1);
         ts = tags(linkIndex(psi,j-1));
         auto spec = diagPosSemiDef(rho,U,D,{dargs,"Tags=",ts});
-        O = O*U*psi(j-1)*K(j-1);
+        O = contractSequence({O,U,psi(j-1),K(j-1)});
         res.ref(j) = dag(U);
         if(verbose) printfln("  j=%02d truncerr=%.2E dim=%d",j,spec.truncerr(),dim(commonIndex(U,D)));
         }
 
+    if(verbose) printfln("  Peak environment memory %.1f MB",E.peakBytes()/1E6);
+
     if(normalize) O /= norm(O);
     res.ref(1) = O;
     res.leftLim(0);
@@ -292,6 +542,84 @@ densityMatrixApplyMPOImpl(MPO const& K,
     return res;
     }
 
+MPS
+zipUpApplyMPOImpl(MPO const& K,
+                  MPS const& psi,
+                  Args args)
+    {
+    if( args.defined("Maxm") )
+      {
+      if( args.defined("MaxDim") )
+        {
+        Global::warnDeprecated("Args Maxm and MaxDim are both defined. Maxm is deprecated in favor of MaxDim, MaxDim will be used.");
+        }
+      else
+        {
+        Global::warnDeprecated("Arg Maxm is deprecated in favor of MaxDim.");
+        args.add("MaxDim",args.getInt("Maxm"));
+        }
+      }
+
+    auto cutoff = args.getReal("Cutoff",1E-13);
+    auto dargs = Args{"Cutoff",cutoff};
+    if(args.defined("MaxDim")) dargs.add("MaxDim",args.getInt("MaxDim"));
+    dargs.add("RespectDegenerate",args.getBool("RespectDegenerate",true));
+    auto verbose = args.getBool("Verbose",false);
+    auto normalize = args.getBool("Normalize",false);
+
+    auto N = length(psi);
+    if(length(K) != N) Error("Mismatched lengths of MPS and MPO in applyMPO method 'ZipUp'");
+
+    for( auto n : range1(N) )
+      {
+      if( commonIndex(psi(n),K(n)) != siteIndex(psi,n) )
+          Error("MPS and MPO have different site indices in applyMPO method 'ZipUp'");
+      }
+
+    //The truncations made while zipping up
+    //are only close to optimal if the part of
+    //psi not yet zipped is right-orthogonal
+    auto x = psi;
+    x.position(1);
+
+    auto res = x;
+
+    //Zip up from the left: C holds the part of K|x>
+    //up to site j not yet factorized into the
+    //left-orthogonal tensors res(j).
+    //The right side of each bond is not orthogonal
+    //yet, so truncate only loosely here (a smaller
+    //cutoff and twice MaxDim) and leave the final
+    //truncation to the sweep back below
+    auto zargs = Args{"Cutoff",0.1*cutoff};
+    if(args.defined("MaxDim")) zargs.add("MaxDim",2*args.getInt("MaxDim"));
+    zargs.add("RespectDegenerate",dargs.getBool("RespectDegenerate"));
+    auto C = x(1)*K(1);
+    for(auto j : range1(N-1))
+        {
+        auto sj = uniqueSiteIndex(K,x,j);
+        auto Uis = (j == 1) ? IndexSet(sj) : IndexSet(commonIndex(C,res(j-1)),sj);
+        auto [U,S,V] = svd(C,Uis,{zargs,"LeftTags=",tags(linkIndex(x,j))});
+        if(verbose) printfln("  j=%02d dim=%d",j,dim(commonIndex(U,S)));
+        res.ref(j) = U;
+        C = S*V;
+        C *= x(j+1);
+        C *= K(j+1);
+        }
+    res.ref(N) = C;
+    res.leftLim(N-1);
+    res.rightLim(N+1);
+
+    //res is left-orthogonal, so truncating
+    //while moving its center back to site 1
+    //is optimal
+    res.position(1,dargs);
+
+    if(normalize) res.ref(1) /= norm(res(1));
+
+    return res;
+    }
+
 void
 fitApplyMPOImpl(Real fac,
                 MPS const& x,
@@ -512,84 +840,6 @@ applyExpH(MPS const& psi,
 // Deprecated
 //
 
-//
-// For now this is unsupported
-// We can consider bringing it back for example
-// as a way to get a default starting MPS
-// for fitApplyMPOImpl
-//
-
-//void 
-//zipUpApplyMPOImpl(MPS const& psi, 
-//                  MPO const& K, 
-//                  MPS& res, 
-//                  Args const& args)
-//    {
-//    const
-//    bool allow_arb_position = args.getBool("AllowArbPosition",false);
-//
-//    if(&psi == &res)
-//        Error("psi and res must be different MPS instances");
-//
-//    auto N = length(psi);
-//    if(length(K) != N) 
-//        Error("Mismatched N in ApplyMPO() ZipUp method");
-//
-//    if(!itensor::isOrtho(psi) || itensor::orthoCenter(psi) != 1)
-//        Error("Ortho center of psi must be site 1");
-//
-//    if(!allow_arb_position && (!itensor::isOrtho(K) || itensor::orthoCenter(K) != 1))
-//        Error("Ortho center of K must be site 1");
-//
-//#ifdef DEBUG
-//    checkQNs(psi);
-//    checkQNs(K);
-//    /*
-//    cout << "Checking divergence in zip" << endl;
-//    for(int i = 1; i <= N; i++)
-//	div(psi(i));
-//    for(int i = 1; i <= N; i++)
-//	div(K(i));
-//    cout << "Done Checking divergence in zip" << endl;
-//    */
-//#endif
-//
-//    res = psi; 
-//    res.replaceTags("0","4","Link");
-//    res.replaceTags("0","1","Site");
-//
-//    ITensor clust,nfork;
-//    vector<int> midsize(N);
-//    int maxdim = 1;
-//    for(int i = 1; i < N; i++)
-//        {
-//        if(i == 1) { clust = psi(i) * K(i); }
-//        else { clust = nfork * (psi(i) * K(i)); }
-//        if(i == N-1) break; //No need to SVD for i == N-1
-//
-//        Index oldmid = linkIndex(res,i); assert(oldmid.dir() == Out);
-//        nfork = ITensor(linkIndex(psi,i),linkIndex(K,i-1),oldmid);
-//        //if(clust.iten_size() == 0)	// this product gives 0 !!
-//	    //throw ResultIsZero("clust.iten size == 0");
-//        denmatDecomp(clust, res.ref(i), nfork,Fromleft,args);
-//        Index mid = commonIndex(res(i),nfork);
-//        //assert(mid.dir() == In);
-//        mid.dag();
-//        midsize[i] = dim(mid);
-//        maxdim = std::max(midsize[i],maxdim);
-//        assert(linkIndex(res,i+1).dir() == Out);
-//        res.ref(i+1) = ITensor(mid,prime(res.sites()(i+1)),linkIndex(res,i+1));
-//        }
-//    nfork = clust * psi(N) * K(N);
-//    //if(nfork.iten_size() == 0)	// this product gives 0 !!
-//    //throw ResultIsZero("nfork.iten size == 0");
-//
-//    res.svdBond(N-1,nfork,Fromright,args);
-//    res.noPrime("Link");
-//    res.replaceTags("1","0","Site");
-//    res.position(1);
-//    } //void zipUpApplyMPOImpl
-
 //
 // These versions calculate |res> = |psiA> + mpofac*H*|psiB>
 // Currently they are unsupported
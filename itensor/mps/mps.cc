@@ -18,6 +18,10 @@
 #include "itensor/mps/localop.h"
 #include "itensor/util/print_macro.h"
 #include "itensor/util/str.h"
+#include "itensor/tensorfile.h"
+#include "itensor/contractsequence.h"
+#include <dirent.h>
+#include <unistd.h>
 
 namespace itensor {
 
@@ -334,7 +338,7 @@ read(std::string const& dirname)
 
     for(auto j : range(A_.size()))
         {
-    	readFromFile(AFName(j,dirname),A_.at(j));
+    	readFromMappedFile(AFName(j,dirname),A_.at(j));
         }
     }
 
@@ -372,12 +376,12 @@ setBond(int b) const
         {
         if(A_.at(atb_))
             {
-            writeToFile(AFName(atb_),A_.at(atb_));
+            writeToMappedFile(AFName(atb_),A_.at(atb_));
             A_.at(atb_) = ITensor();
             }
         if(A_.at(atb_+1))
             {
-            writeToFile(AFName(atb_+1),A_.at(atb_+1));
+            writeToMappedFile(AFName(atb_+1),A_.at(atb_+1));
             if(atb_+1 != b) A_.at(atb_+1) = ITensor();
             }
         ++atb_;
@@ -386,12 +390,12 @@ setBond(int b) const
         {
         if(A_.at(atb_))
             {
-            writeToFile(AFName(atb_),A_.at(atb_));
+            writeToMappedFile(AFName(atb_),A_.at(atb_));
             if(atb_ != b+1) A_.at(atb_) = ITensor();
             }
         if(A_.at(atb_+1))
             {
-            writeToFile(AFName(atb_+1),A_.at(atb_+1));
+            writeToMappedFile(AFName(atb_+1),A_.at(atb_+1));
             A_.at(atb_+1) = ITensor();
             }
         --atb_;
@@ -403,12 +407,12 @@ setBond(int b) const
     //
     if(!A_.at(b))
         {
-        readFromFile(AFName(b),A_.at(b));
+        readFromMappedFile(AFName(b),A_.at(b));
         }
 
     if(!A_.at(b+1))
         {
-        readFromFile(AFName(b+1),A_.at(b+1));
+        readFromMappedFile(AFName(b+1),A_.at(b+1));
         }
 
     //if(b == 1)
@@ -848,7 +852,7 @@ initWrite(Args const& args)
         //later logic assumes null means written to disk
         for(size_t j = 0; j < A_.size(); ++j)
             {
-            if(!A_.at(j)) writeToFile(AFName(j),A_.at(j));
+            if(!A_.at(j)) writeToMappedFile(AFName(j),A_.at(j));
             }
 
         if(args.getBool("WriteAll",false))
@@ -856,7 +860,7 @@ initWrite(Args const& args)
             for(int j = 0; j < int(A_.size()); ++j)
                 {
                 if(!A_.at(j)) continue;
-                writeToFile(AFName(j),A_.at(j));
+                writeToMappedFile(AFName(j),A_.at(j));
                 if(j < atb_ || j > atb_+1)
                     {
                     A_[j] = ITensor{};
@@ -868,6 +872,39 @@ initWrite(Args const& args)
         }
     }
 
+//
+// Hard link every file of directory from into
+// directory to. If any link cannot be made (e.g. to
+// is on another file system) the links made so far
+// are removed and false is returned.
+//
+static bool
+linkDirFiles(string const& from, string const& to)
+    {
+    auto* dir = opendir(from.c_str());
+    if(!dir) return false;
+    auto made = vector<string>{};
+    auto ok = true;
+    while(auto* ent = readdir(dir))
+        {
+        auto name = string(ent->d_name);
+        if(name == "." || name == "..") continue;
+        auto target = to + "/" + name;
+        if(link((from + "/" + name).c_str(),target.c_str()) != 0)
+            {
+            ok = false;
+            break;
+            }
+        made.push_back(target);
+        }
+    closedir(dir);
+    if(!ok)
+        {
+        for(auto& f : made) unlink(f.c_str());
+        }
+    return ok;
+    }
+
 void MPS::
 copyWriteDir()
     {
@@ -877,9 +914,14 @@ copyWriteDir()
         string global_write_dir = Args::global().getString("WriteDir","./");
         writedir_ = mkTempDir("psi",global_write_dir);
 
-        string cmdstr = "cp -r " + old_writedir + "/* " + writedir_;
-        println("Copying MPS with doWrite()==true. Issuing command: ",cmdstr);
-        system(cmdstr.c_str());
+        //Tensor files are only ever replaced (never modified
+        //in place), so the copy can share them via hard links
+        if(!linkDirFiles(old_writedir,writedir_))
+            {
+            string cmdstr = "cp -r " + old_writedir + "/* " + writedir_;
+            println("Copying MPS with doWrite()==true. Issuing command: ",cmdstr);
+            system(cmdstr.c_str());
+            }
         }
     }
 
@@ -1452,7 +1494,7 @@ innerC(MPS const& psi,
     auto L = phi(1) * psidag(1);
     if(N == 1) return eltC(L);
     for(auto i : range1(2,N) ) 
-        L = L * phi(i) * psidag(i);
+        L = contractSequence({L,phi(i),psidag(i)});
     return eltC(L);
     }
 
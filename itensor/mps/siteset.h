@@ -15,8 +15,12 @@
 //
 #ifndef __ITENSOR_SITESET_H
 #define __ITENSOR_SITESET_H
+#include <mutex>
+#include <sstream>
+#include <typeinfo>
 #include "itensor/itensor.h"
 #include "itensor/util/str.h"
+#include "itensor/util/lrucache.h"
 
 namespace itensor {
 
@@ -83,10 +87,24 @@ class SiteSet
 
     //Get the operator indicated by
     //"opname" located at site i
+    //
+    //Operators are cached: sites of the same type with
+    //indices of the same dimension and QN blocks share
+    //one copy of each operator (for given args), made
+    //on first use, with the site index replaced when
+    //it is looked up
     ITensor
     op(String const& opname, int i,
        Args const& args = Args::global()) const;
 
+    //Hits and misses of the operator cache
+    //(shared by all copies of this SiteSet)
+    CacheStats
+    opCacheStats() const;
+
+    void
+    clearOpCache() const;
+
     void 
     read(std::istream & s) { readType<GenericSite>(s); }
 
@@ -124,6 +142,12 @@ class SiteSet
     void
     init(SiteStore && sites);
 
+    private:
+
+    ITensor
+    makeOp(String const& opname, int i,
+           Args const& args) const;
+
     template<typename SiteType>
     void
     readType(std::istream & s);
@@ -214,25 +238,56 @@ class GenericSite
     };
 
 
+//
+// Operators made by SiteSet::op, keyed on the site type,
+// the shape of the site index, the operator name and
+// the args, together with the site index they were
+// made for
+//
+struct SiteOpCache
+    {
+    struct Entry
+        {
+        Index s;
+        ITensor op;
+        };
+
+    std::mutex m;
+    LRUCache<std::string,Entry> ops;
+    CacheCounters counters;
+
+    SiteOpCache() : ops(10000) { }
+    };
+
 struct SiteStore
     {
     using sptr = std::unique_ptr<SiteBase>;
     using storage = std::vector<sptr>;
     private:
     storage sites_;
+    std::unique_ptr<SiteOpCache> opcache_;
     public:
 
-    SiteStore() { }
+    SiteStore() : opcache_(new SiteOpCache) { }
 
-    SiteStore(int N) : sites_(1+N) { }
+    SiteStore(int N) : sites_(1+N), opcache_(new SiteOpCache) { }
 
     template<typename SiteType>
     void
     set(int i, SiteType && s) 
         {
         sites_.at(i) = sptr(new SiteHolder<SiteType>(std::move(s)));
+        opcache_.reset(new SiteOpCache);
         }
 
+    SiteOpCache&
+    opCache() const { return *opcache_; }
+
+    std::string
+    opKey(int j,
+          std::string const& opname,
+          Args const& args) const;
+
     int
     length() const { return sites_.empty() ? 0 : sites_.size()-1ul; }
 
@@ -269,6 +324,25 @@ struct SiteStore
         }
     };
 
+inline std::string SiteStore::
+opKey(int j,
+      std::string const& opname,
+      Args const& args) const
+    {
+    if(not sites_.at(j)) Error("Unassigned site in SiteStore");
+    auto s = sites_[j]->index();
+    auto key = std::ostringstream{};
+    key.precision(17);
+    key << typeid(*sites_[j]).name() << "|" << opname << "|" << dim(s) << "," << dir(s);
+    for(auto b : range1(nblock(s)))
+        {
+        key << "|" << qn(s,b) << "," << blocksize(s,b);
+        }
+    key << "|" << args;
+    if(!args.isGlobal()) key << Args::global();
+    return key.str();
+    }
+
 
 inline SiteSet::
 SiteSet(int N, int d)
@@ -365,6 +439,73 @@ op(String const& opname,
    Args const& args) const
     { 
     if(not *this) Error("Cannot call .op(..) on default-initialized SiteSet");
+    auto& cache = sites_->opCache();
+    auto key = sites_->opKey(i,opname,args);
+    auto s = si(i);
+    auto Op = ITensor{};
+    auto s0 = Index{};
+        {
+        std::lock_guard<std::mutex> lock(cache.m);
+        auto* e = cache.ops.find(key);
+        if(e)
+            {
+            Op = e->op;
+            s0 = e->s;
+            }
+        }
+    if(!Op)
+        {
+        ++cache.counters.misses;
+        Op = makeOp(opname,i,args);
+        std::lock_guard<std::mutex> lock(cache.m);
+        cache.ops.insert(key,SiteOpCache::Entry{s,Op});
+        return Op;
+        }
+    ++cache.counters.hits;
+    if(s0 == s) return Op;
+    //Same operator made for another site:
+    //share its storage, with s0 replaced by s
+    auto is = std::vector<Index>{};
+    is.reserve(Op.order());
+    for(auto J : Op.inds())
+        {
+        if(noPrime(J) == s0)
+            {
+            auto K = prime(s,primeLevel(J));
+            K.setDir(dir(J));
+            is.push_back(K);
+            }
+        else
+            {
+            is.push_back(J);
+            }
+        }
+    return ITensor{IndexSet(is),std::move(Op.store()),Op.scale()};
+    }
+
+CacheStats inline SiteSet::
+opCacheStats() const
+    {
+    if(not *this) return CacheStats{};
+    return CacheStats(sites_->opCache().counters);
+    }
+
+void inline SiteSet::
+clearOpCache() const
+    {
+    if(not *this) return;
+    auto& cache = sites_->opCache();
+    std::lock_guard<std::mutex> lock(cache.m);
+    cache.ops.clear();
+    cache.counters.hits = 0;
+    cache.counters.misses = 0;
+    }
+
+ITensor inline SiteSet::
+makeOp(String const& opname, 
+       int i, 
+       Args const& args) const
+    { 
     if(opname == "Id")
         {
         auto s = si(i);
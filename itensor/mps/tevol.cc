@@ -0,0 +1,185 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "itensor/mps/tevol.h"
+#include "itensor/util/threadpool.h"
+
+namespace itensor {
+
+//
+// MPS psi = B_1 B_2 ... B_N kept with the singular values
+// lambda_b of every bond (Vidal's Gamma-lambda form, stored
+// as B_j = Gamma_j lambda_j so that applying a gate never
+// divides by small singular values). Each B_j with j > 1 is
+// right-orthogonal and lambda_{j-1} B_j ... B_N is the
+// Schmidt decomposition at bond j-1, so a gate on sites
+// j,j+1 only needs B_j, B_{j+1} and lambda_{j-1}: gates on
+// disjoint bonds can be applied at the same time.
+//
+class VidalMPS
+    {
+    int N_ = 0;
+    std::vector<ITensor> B_,
+                         L_; //L_[b] is lambda_b, with one index
+                             //shared with B_{b+1}
+    public:
+
+    explicit
+    VidalMPS(MPS const& psi)
+      : N_(length(psi)),
+        B_(N_+1),
+        L_(N_+1)
+        {
+        for(auto j : range1(N_)) B_[j] = psi(j);
+        canonicalize();
+        }
+
+    //Bring B_1,...,B_N into the form above
+    //(exactly, without truncating)
+    void
+    canonicalize()
+        {
+        //Left-orthogonalize
+        for(auto j : range1(N_-1))
+            {
+            auto l = commonIndex(B_[j],B_[j+1]);
+            ITensor U(uniqueInds(B_[j],B_[j+1])),S,V;
+            svd(B_[j],U,S,V,{"Truncate=",false,"LeftTags=",tags(l)});
+            B_[j] = U;
+            B_[j+1] *= S*V;
+            }
+        //Right-orthogonalize, keeping the singular values
+        for(int j = N_; j > 1; --j)
+            {
+            auto l = commonIndex(B_[j-1],B_[j]);
+            ITensor U(l),S,V;
+            svd(B_[j],U,S,V,{"Truncate=",false,"RightTags=",tags(l)});
+            B_[j] = V;
+            L_[j-1] = S;
+            B_[j-1] *= U*S;
+            }
+        }
+
+    //Apply gate G on sites j = G.i1() and j+1 = G.i2(),
+    //truncating the new bond as MPS::svdBond would
+    void
+    apply(BondGate const& G,
+          Args const& args)
+        {
+        auto j = G.i1();
+        auto th0 = B_[j]*B_[j+1]*G.gate();
+        th0.replaceTags("Site,1","Site,0");
+        auto th = (j > 1) ? L_[j-1]*th0 : th0;
+        auto l = commonIndex(B_[j],B_[j+1]);
+        ITensor U(uniqueInds(th,B_[j+1])),S,V;
+        svd(th,U,S,V,{args,"RightTags=",tags(l)});
+        B_[j] = th0*dag(V);
+        B_[j+1] = V;
+        L_[j] = S;
+        }
+
+    Real
+    norm() const { return itensor::norm(B_[1]); }
+
+    Real
+    normalize()
+        {
+        auto nrm = norm();
+        B_[1] /= nrm;
+        return nrm;
+        }
+
+    size_t
+    cost(BondGate const& G) const
+        {
+        return dim(inds(B_[G.i1()]))*dim(inds(B_[G.i2()]));
+        }
+
+    void
+    toMPS(MPS & psi) const
+        {
+        for(auto j : range1(N_)) psi.ref(j) = B_[j];
+        psi.leftLim(0);
+        psi.rightLim(2);
+        }
+    };
+
+Real
+gateTEvolLayers(std::vector<std::vector<BondGate>> const& layers,
+                int nt,
+                Real tstep,
+                Real ttotal,
+                MPS & psi, 
+                Observer& obs,
+                Args args)
+    {
+    const bool do_normalize = args.getBool("Normalize",true);
+    // Truncate blocks of degenerate singular values
+    args.add("RespectDegenerate",args.getBool("RespectDegenerate",true));
+
+    //Gates other than real-time and swap gates are
+    //not unitary and spoil the canonical form, which is
+    //then restored after every time step
+    auto unitary = true;
+    for(auto& layer : layers)
+    for(auto& G : layer)
+        {
+        if(G.i2() != G.i1()+1)
+            {
+            Error("gateTEvol with \"Method\"=\"Parallel\" requires nearest-neighbor gates");
+            }
+        if(!(G.type() == BondGate::tReal || G.type() == BondGate::Swap)) unitary = false;
+        }
+
+    auto V = VidalMPS(psi);
+    Real tot_norm = V.norm();
+
+    auto& pool = threadPool();
+    Real tsofar = 0;
+    for(auto tt : range1(nt))
+        {
+        for(auto& layer : layers)
+            {
+            auto costs = std::vector<double>(layer.size());
+            for(auto n : range(layer.size())) costs[n] = V.cost(layer[n]);
+            parallelFor(pool,costs,pool.nthread(),[&](size_t n)
+                {
+                V.apply(layer[n],args);
+                });
+            }
+
+        if(!unitary) V.canonicalize();
+        if(do_normalize)
+            {
+            tot_norm *= V.normalize();
+            }
+        V.toMPS(psi);
+
+        tsofar += tstep;
+
+        args.add("TimeStepNum",tt);
+        args.add("Time",tsofar);
+        args.add("TotalTime",ttotal);
+        obs.measure(args);
+        }
+    if(args.getBool("Verbose",false))
+        {
+        printfln("\nTotal time evolved = %.5f\n",tsofar);
+        }
+
+    return tot_norm;
+    }
+
+} //namespace itensor
@@ -29,6 +29,17 @@ namespace itensor {
 //
 // Arguments recognized:
 //    "Verbose": if true, print useful information to stdout
+//    "Method": "Sequential" (default) applies one gate after
+//              another, moving the orthogonality center of psi
+//              to each gate.
+//              "Parallel" keeps psi in Vidal (Gamma-lambda) form
+//              and applies runs of consecutive gates acting on
+//              disjoint bonds (e.g. the even or odd layer of a
+//              brickwork gate list) at once on the threads of
+//              threadPool(). Gates must act on neighboring sites.
+//              psi is written back after every time step.
+//    "Cutoff", "MaxDim", ...: truncation of each bond after
+//              applying a gate, as for MPS::svdBond
 //
 template <class Iterable>
 Real
@@ -47,6 +58,45 @@ gateTEvol(Iterable const& gatelist,
           Observer& obs,
           Args args = Args::global());
 
+//
+// Split a gate list into layers: runs of consecutive
+// gates acting on disjoint sets of sites
+//
+template <class Iterable>
+std::vector<std::vector<BondGate>>
+gateLayers(Iterable const& gatelist)
+    {
+    auto layers = std::vector<std::vector<BondGate>>{};
+    auto used = std::vector<int>{};
+    for(auto& g : gatelist)
+        {
+        auto overlaps = false;
+        for(auto s : used) 
+            {
+            if(s == g.i1() || s == g.i2()) overlaps = true;
+            }
+        if(layers.empty() || overlaps)
+            {
+            layers.emplace_back();
+            used.clear();
+            }
+        layers.back().push_back(g);
+        used.push_back(g.i1());
+        used.push_back(g.i2());
+        }
+    return layers;
+    }
+
+//gateTEvol with "Method"="Parallel" (see tevol.cc)
+Real
+gateTEvolLayers(std::vector<std::vector<BondGate>> const& layers,
+                int nt,
+                Real tstep,
+                Real ttotal,
+                MPS & psi, 
+                Observer& obs,
+                Args args);
+
 //
 //
 // Implementations
@@ -75,6 +125,11 @@ gateTEvol(Iterable const& gatelist,
         printfln("Taking %d steps of timestep %.5f, total time %.5f",nt,tstep,ttotal);
         }
 
+    if(args.getString("Method","Sequential") == "Parallel")
+        {
+        return gateTEvolLayers(gateLayers(gatelist),nt,tstep,ttotal,psi,obs,args);
+        }
+
     psi.position(gatelist.front().i1());
     Real tot_norm = norm(psi);
 
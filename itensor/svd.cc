@@ -19,6 +19,8 @@
 #include "itensor/decomp.h"
 #include "itensor/util/print_macro.h"
 #include "itensor/itdata/qutil.h"
+#include "itensor/util/scratch.h"
+#include "itensor/util/threadpool.h"
 
 namespace itensor {
 
@@ -74,12 +76,31 @@ svdImpl(ITensor const& A,
 
     auto do_truncate = args.getBool("Truncate");
     auto thresh = args.getReal("SVDThreshold",1E-3);
+    auto svd_method = toSVDMethod(args.getString("SVDMethod","recursive"));
     auto cutoff = args.getReal("Cutoff",MIN_CUT);
     auto maxdim = args.getInt("MaxDim",MAX_DIM);
     auto mindim = args.getInt("MinDim",1);
     auto doRelCutoff = args.getBool("DoRelCutoff",true);
     auto absoluteCutoff = args.getBool("AbsoluteCutoff",false);
     auto show_eigs = args.getBool("ShowEigs",false);
+    //Randomized SVD: "SVDRandomized" forces it on or off;
+    //by default it is used for blocks where only a small
+    //fraction (< "SVDRandomizedRatio") of the singular values
+    //can be kept because of MaxDim
+    auto rsvd_oversample = args.getInt("SVDOversample",10);
+    auto rsvd_niter = args.getInt("SVDPowerIter",2);
+    auto rsvd_ratio = args.getReal("SVDRandomizedRatio",0.2);
+    auto rsvd_force = args.defined("SVDRandomized");
+    auto rsvd_use = args.getBool("SVDRandomized",true);
+    //Number of singular values to compute for a block with nsv of them
+    //(fewer than nsv means use the randomized SVD)
+    auto computeDim = [=](long nsv) -> long
+        {
+        if(!do_truncate || !rsvd_use || maxdim >= nsv) return nsv;
+        auto k = std::min(nsv,maxdim+rsvd_oversample);
+        if(rsvd_force || k <= rsvd_ratio*nsv) return k;
+        return nsv;
+        };
     auto litagset = getTagSet(args,"LeftTags","Link,U");
     auto ritagset = getTagSet(args,"RightTags","Link,V");
     if( litagset == ritagset ) Error("In SVD, must specify different tags for the new left and right indices (with Args 'LeftTags' and 'RightTags')");
@@ -91,7 +112,24 @@ svdImpl(ITensor const& A,
         Mat<T> UU,VV;
         Vector DD;
 
-        SVD(M,UU,DD,VV,thresh);
+        auto nsv = long(std::min(nrows(M),ncols(M)));
+        auto k = computeDim(nsv);
+        //Weight of the singular values not computed
+        //by the randomized SVD (if used)
+        Real rest = 0;
+        if(k < nsv)
+            {
+            resize(UU,nrows(M),k);
+            resize(VV,ncols(M),k);
+            resize(DD,k);
+            randomizedSVDRef(M,makeRef(UU),makeRef(DD),makeRef(VV),rsvd_niter,svd_method,thresh);
+            rest = sqr(norm(M));
+            for(auto el : DD) rest -= sqr(el);
+            }
+        else
+            {
+            SVD(M,UU,DD,VV,thresh,svd_method);
+            }
 
         //conjugate VV so later we can just do
         //U*D*V to reconstruct ITensor A:
@@ -105,6 +143,15 @@ svdImpl(ITensor const& A,
             {
             probs = DD;
             for(auto j : range(probs)) probs(j) = sqr(probs(j));
+            if(k < nsv)
+                {
+                //The uncomputed weight goes last as a single
+                //entry, so that truncate counts it in the
+                //truncation error; since k > MaxDim it is
+                //always discarded
+                resize(probs,k+1);
+                probs(k) = std::max(0.,rest);
+                }
             }
 
         Real truncerr = 0;
@@ -167,21 +214,44 @@ svdImpl(ITensor const& A,
     else
         {
         auto compute_qn = args.getBool("ComputeQNs",false);
+        //Cap on threads used for the block SVDs,
+        //e.g. 1 if BLAS/LAPACK is itself multithreaded
+        auto decomp_nthread = args.getInt("DecompNThread",getNThread());
 
         auto blocks = doTask(GetBlocks<T>{A.inds(),uI,vI},A.store());
 
         auto Nblock = blocks.size();
         if(Nblock == 0) throw ResultIsZero("IQTensor has no blocks");
 
-        //TODO: optimize allocation/lookup of Umats,Vmats
-        //      etc. by allocating memory ahead of time (see algs.cc)
-        //      and making Umats a vector of MatrixRef's to this memory
-        auto Umats = vector<Mat<T>>(Nblock);
-        auto Vmats = vector<Mat<T>>(Nblock);
-
-        //TODO: allocate dvecs in a single allocation
-        //      make dvecs a vector<VecRef>
-        auto dvecs = vector<Vector>(Nblock);
+        //Umats, Vmats, and dvecs refer to two
+        //single allocations from the scratch arena
+        size_t UVsize = 0,
+               dsize = 0;
+        for(auto& B : blocks)
+            {
+            auto nsv = computeDim(std::min(nrows(B.M),ncols(B.M)));
+            UVsize += (nrows(B.M)+ncols(B.M))*nsv;
+            dsize += nsv;
+            }
+        auto UVbuf = ScratchBuffer<T>(UVsize);
+        auto dbuf = ScratchBuffer<Real>(dsize);
+
+        auto Umats = vector<MatRef<T>>(Nblock);
+        auto Vmats = vector<MatRef<T>>(Nblock);
+        auto dvecs = vector<VectorRef>(Nblock);
+        size_t UVoff = 0,
+               doff = 0;
+        for(auto b : range(Nblock))
+            {
+            auto& M = blocks[b].M;
+            auto nsv = computeDim(std::min(nrows(M),ncols(M)));
+            Umats[b] = makeMatRef(UVbuf.data()+UVoff,nrows(M)*nsv,nrows(M),nsv);
+            UVoff += nrows(M)*nsv;
+            Vmats[b] = makeMatRef(UVbuf.data()+UVoff,ncols(M)*nsv,ncols(M),nsv);
+            UVoff += ncols(M)*nsv;
+            dvecs[b] = makeVecRef(dbuf.data()+doff,nsv);
+            doff += nsv;
+            }
 
         auto alleig = stdx::reserve_vector<Real>(std::min(dim(uI),dim(vI)));
 
@@ -194,18 +264,46 @@ svdImpl(ITensor const& A,
         if(dim(uI) == 0) throw ResultIsZero("dim(uI) == 0");
         if(dim(vI) == 0) throw ResultIsZero("dim(vI) == 0");
 
+        //The blocks are independent, so decompose
+        //them on the thread pool, largest first
+        auto costs = vector<double>(Nblock);
         for(auto b : range(Nblock))
             {
             auto& M = blocks[b].M;
-            auto& UU = Umats.at(b);
+            costs[b] = double(nrows(M))*ncols(M)*std::min(nrows(M),ncols(M));
+            }
+        parallelFor(threadPool(),costs,decomp_nthread,[&](size_t b)
+            {
+            auto& M = blocks[b].M;
             auto& VV = Vmats.at(b);
-            auto& d =  dvecs.at(b);
-
-            SVD(M,UU,d,VV,thresh);
+            if(ncols(VV) < std::min(nrows(M),ncols(M)))
+                {
+                randomizedSVDRef(M,Umats.at(b),dvecs.at(b),VV,rsvd_niter,svd_method,thresh);
+                }
+            else
+                {
+                SVDRef(M,Umats.at(b),dvecs.at(b),VV,thresh,svd_method);
+                }
 
             //conjugate VV so later we can just do
             //U*D*V to reconstruct ITensor A:
             conjugate(VV);
+            });
+
+        //Weight of the singular values not computed
+        //by the randomized SVD (if used for any block)
+        auto randomized = false;
+        Real rest = 0;
+        for(auto b : range(Nblock))
+            {
+            auto& d =  dvecs.at(b);
+            auto& M = blocks[b].M;
+            if(d.size() < size_t(std::min(nrows(M),ncols(M))))
+                {
+                randomized = true;
+                rest += sqr(norm(M));
+                for(auto sval : d) rest -= sqr(sval);
+                }
 
             alleig.insert(alleig.end(),d.begin(),d.end());
             if(compute_qn)
@@ -227,6 +325,10 @@ svdImpl(ITensor const& A,
         //irrespective of quantum numbers
         stdx::sort(alleig,std::greater<Real>{});
         if(compute_qn) stdx::sort(alleigqn,std::greater<EigQN>{});
+        //The uncomputed weight goes last as a single entry
+        //(always discarded since MaxDim is exceeded),
+        //so that truncate counts it in the truncation error
+        if(randomized) alleig.push_back(std::max(0.,rest));
 
         auto probs = Vector(move(alleig),VecRange{alleig.size()});
 
@@ -299,13 +401,13 @@ svdImpl(ITensor const& A,
 
             if(this_m == 0) 
                 { 
-                d.clear();
+                d = VectorRef{};
                 B.M.clear();
                 assert(not B.M);
                 continue; 
                 }
 
-            resize(d,this_m);
+            d = subVector(d,0,this_m);
             qn(uI,1+B.i1);
             Liq.emplace_back(qn(uI,1+B.i1),this_m);
             Riq.emplace_back(qn(vI,1+B.i2),this_m);
@@ -348,8 +450,7 @@ svdImpl(ITensor const& A,
             assert(pU.data() != nullptr);
             assert(uI.blocksize0(B.i1) == long(nrows(UU)));
             auto Uref = makeMatRef(pU,uI.blocksize0(B.i1),L.blocksize0(n));
-            reduceCols(UU,L.blocksize0(n));
-            Uref &= UU;
+            Uref &= columns(UU,0,L.blocksize0(n));
 
             auto dind = stdx::make_array(n,n);
             auto pD = getBlock(Dstore,Dis,dind);
@@ -362,11 +463,10 @@ svdImpl(ITensor const& A,
             assert(pV.data() != nullptr);
             assert(vI.blocksize0(B.i2) == long(nrows(VV)));
             auto Vref = makeMatRef(pV.data(),pV.size(),vI.blocksize0(B.i2),R.blocksize0(n));
-            reduceCols(VV,R.blocksize0(n));
             //println("Doing Vref &= VV");
             //Print(Vref.range());
             //Print(VV.range());
-            Vref &= VV;
+            Vref &= columns(VV,0,R.blocksize0(n));
 
             /////////DEBUG
             //Matrix D(d.size(),d.size());
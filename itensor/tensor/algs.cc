@@ -16,9 +16,11 @@
 #include <limits>
 #include <stdexcept>
 #include <tuple>
+#include <random>
 #include "itensor/tensor/lapack_wrap.h"
 #include "itensor/tensor/algs.h"
 #include "itensor/util/iterate.h"
+#include "itensor/util/scratch.h"
 #include "itensor/global.h"
 
 using std::move;
@@ -458,17 +460,29 @@ SVDRefImpl(MatRefc<T> const& M,
         throw std::runtime_error("SVD (ref version), wrong size of D");
 #endif
 
+    //Temporaries (rho, Mconj, b, bu, bv, ...)
+    //are taken from the scratch arena
+    auto makeScratchMat = [](ScratchBuffer<T> & buf, size_t nr, size_t nc)
+        {
+        buf = ScratchBuffer<T>(nr*nc);
+        return makeMatRef(buf.data(),buf.size(),nr,nc);
+        };
+
     //Form 'density matrix' rho
-    Mat<T> rho,
-           Mconj;
+    ScratchBuffer<T> rhobuf,
+                     Mconjbuf;
+    auto rho = makeScratchMat(rhobuf,Mr,Mr);
+    auto Mconj = MatRef<T>{};
     if(isCplx(M)) 
         {
-        Mconj = conj(M);
-        rho = M * transpose(Mconj);
+        Mconj = makeScratchMat(Mconjbuf,Mr,Mc);
+        Mconj &= M;
+        conjugate(Mconj);
+        mult(M,transpose(Mconj),rho);
         }
     else
         {
-        rho = M * transpose(M);
+        mult(M,transpose(M),rho);
         }
 
     //Diagonalize rho: evals are squares of singular vals
@@ -552,8 +566,7 @@ SVDRefImpl(MatRefc<T> const& M,
      //   }
 
     //reuse rho's storage to avoid allocation
-    auto mv = move(rho);
-    reduceCols(mv,n);
+    auto mv = makeMatRef(rhobuf.data(),rhobuf.size(),Mr,n);
 
     auto u = columns(U,start,ncols(U));
     auto v = columns(V,start,ncols(V));
@@ -561,21 +574,36 @@ SVDRefImpl(MatRefc<T> const& M,
     //b should be close to diagonal
     //but may not be perfect - fix it up below
     mult(M,v,mv);
-    Mat<T> b;
-    if(isCplx(M)) b = conj(transpose(u))*mv;
-    else          b = transpose(u)*mv;
+    ScratchBuffer<T> bbuf,
+                     bubuf,
+                     bvbuf,
+                     Xbuf;
+    auto b = makeScratchMat(bbuf,n,n);
+    if(isCplx(M)) 
+        {
+        //reuse Mconj's storage (Mr*Mc >= Mr*n) for conj(u)
+        auto uc = makeMatRef(Mconjbuf.data(),Mconjbuf.size(),Mr,n);
+        uc &= u;
+        conjugate(uc);
+        mult(transpose(uc),mv,b);
+        }
+    else
+        {
+        mult(transpose(u),mv,b);
+        }
 
     auto d = subVector(D,start,Mr);
-    Mat<T> bu(n,n),
-           bv(n,n);
-    SVDRef(makeRef(b),makeRef(bu),d,makeRef(bv),thresh);
+    auto bu = makeScratchMat(bubuf,n,n);
+    auto bv = makeScratchMat(bvbuf,n,n);
+    SVDRef(makeRefc(b),bu,d,bv,thresh);
 
     //reuse mv's storage to avoid allocation
-    auto W = move(mv);
+    auto W = mv;
     mult(u,bu,W);
     u &= W;
 
-    auto X = v*bv;
+    auto X = makeScratchMat(Xbuf,Mc,n);
+    mult(v,bv,X);
     v &= X;
 
 #ifdef CHKSVD
@@ -598,6 +626,158 @@ SVDRef(MatRefc<T> const& M,
 template void SVDRef(MatRefc<Real> const&,MatRef<Real> const&, VectorRef const&, MatRef<Real> const&,Real);
 template void SVDRef(MatRefc<Cplx> const&,MatRef<Cplx> const&, VectorRef const&, MatRef<Cplx> const&,Real);
 
+SVDMethod
+toSVDMethod(std::string const& name)
+    {
+    if(name == "recursive") return SVDMethod::Recursive;
+    if(name == "gesdd") return SVDMethod::Gesdd;
+    if(name == "gesvd") return SVDMethod::Gesvd;
+    throw std::runtime_error("Unknown SVDMethod \""+name+"\" (use recursive, gesdd, or gesvd)");
+    }
+
+//
+// SVD by a single call to LAPACK gesdd or gesvd.
+// Returns false (leaving U, D, V unspecified)
+// if the LAPACK routine did not converge.
+//
+template<typename T>
+bool
+SVDRefLapack(MatRefc<T> const& M,
+             MatRef<T>  const& U, 
+             VectorRef  const& D, 
+             MatRef<T>  const& V,
+             SVDMethod method)
+    {
+    auto Mr = nrows(M), 
+         Mc = ncols(M);
+    auto nsv = std::min(Mr,Mc);
+#ifdef DEBUG
+    if(!(nrows(U)==Mr && ncols(U)==nsv)) 
+        throw std::runtime_error("SVD (LAPACK version), wrong size of U");
+    if(!(nrows(V)==Mc && ncols(V)==nsv)) 
+        throw std::runtime_error("SVD (LAPACK version), wrong size of V");
+    if(D.size()!=nsv)
+        throw std::runtime_error("SVD (LAPACK version), wrong size of D");
+#endif
+    if(nsv == 0) return true;
+
+    //LAPACK destroys its input, and wants
+    //contiguous column-major U and VT
+    ScratchBuffer<T> Abuf(Mr*Mc),
+                     Ubuf(Mr*nsv),
+                     VTbuf(nsv*Mc);
+    auto A = makeMatRef(Abuf.data(),Abuf.size(),Mr,Mc);
+    A &= M;
+    LAPACK_INT info = 0;
+    if(method == SVDMethod::Gesdd)
+        {
+        info = gesdd_wrapper(Mr,Mc,Abuf.data(),D.data(),Ubuf.data(),VTbuf.data());
+        }
+    else
+        {
+        info = gesvd_wrapper(Mr,Mc,Abuf.data(),D.data(),Ubuf.data(),VTbuf.data());
+        }
+    if(info != 0) return false;
+
+    U &= makeMatRef(Ubuf.data(),Ubuf.size(),Mr,nsv);
+    //M = U*D*VT and V = conj(transpose(VT))
+    V &= transpose(makeMatRef(VTbuf.data(),VTbuf.size(),nsv,Mc));
+    if(isCplx(M)) conjugate(V);
+    return true;
+    }
+
+template<typename T>
+void
+SVDRef(MatRefc<T> const& M,
+       MatRef<T>  const& U, 
+       VectorRef  const& D, 
+       MatRef<T>  const& V,
+       Real thresh,
+       SVDMethod method)
+    {
+    if(method != SVDMethod::Recursive)
+        {
+#ifdef DEBUG
+        if(!isContiguous(D)) throw std::runtime_error("SVD (LAPACK version): D must be contiguous");
+#endif
+        if(SVDRefLapack(M,U,D,V,method)) return;
+        }
+    SVDRefImpl(M,U,D,V,thresh);
+    }
+template void SVDRef(MatRefc<Real> const&,MatRef<Real> const&, VectorRef const&, MatRef<Real> const&,Real,SVDMethod);
+template void SVDRef(MatRefc<Cplx> const&,MatRef<Cplx> const&, VectorRef const&, MatRef<Cplx> const&,Real,SVDMethod);
+
+template<typename T>
+void
+randomizedSVDRef(MatRefc<T> const& M,
+                 MatRef<T>  const& U, 
+                 VectorRef  const& D, 
+                 MatRef<T>  const& V,
+                 long niter,
+                 SVDMethod method,
+                 Real thresh)
+    {
+    auto Mr = nrows(M), 
+         Mc = ncols(M);
+    auto k = ncols(U);
+    if(k > std::min(Mr,Mc)) throw std::runtime_error("randomizedSVDRef: more singular values requested than exist");
+#ifdef DEBUG
+    if(!(nrows(U)==Mr && nrows(V)==Mc && ncols(V)==k)) 
+        throw std::runtime_error("randomizedSVDRef: wrong size of U or V");
+    if(D.size()!=k)
+        throw std::runtime_error("randomizedSVDRef: wrong size of D");
+#endif
+    if(k == 0) return;
+
+    ScratchBuffer<T> Qbuf(Mr*k),
+                     Zbuf(Mc*k),
+                     Cbuf(std::max(Mr,Mc)*k),
+                     Bbuf(k*Mc),
+                     Ubbuf(k*k);
+    auto Q = makeMatRef(Qbuf.data(),Qbuf.size(),Mr,k);
+    auto Z = makeMatRef(Zbuf.data(),Zbuf.size(),Mc,k);
+    auto B = makeMatRef(Bbuf.data(),Bbuf.size(),k,Mc);
+    auto Ub = makeMatRef(Ubbuf.data(),Ubbuf.size(),k,k);
+    //Qc holds conj(Q) (just Q in the real case)
+    auto Qc = makeMatRef(Cbuf.data(),Mr*k,Mr,k);
+    auto setQc = [&Q,&Qc]()
+        {
+        Qc &= Q;
+        if(isCplx(Q)) conjugate(Qc);
+        };
+
+    //Q = orthonormal basis for range of M*Omega,
+    //Omega a random Gaussian Mc x k block
+    auto gen = std::mt19937(5489u+Mr*7919u+Mc);
+    auto dist = std::normal_distribution<Real>(0.,1.);
+    for(auto& el : Z) el = dist(gen);
+    mult(M,Z,Q);
+    orthog(Q,2);
+
+    //Power iterations: Q <- orth(M*orth(M^dagger*Q))
+    //sharpen the decay of the sketched spectrum
+    for(long it = 0; it < niter; ++it)
+        {
+        //Z = M^dagger*Q = conj(transpose(M)*conj(Q))
+        setQc();
+        mult(transpose(M),Qc,Z);
+        if(isCplx(Z)) conjugate(Z);
+        orthog(Z,2);
+        mult(M,Z,Q);
+        orthog(Q,2);
+        }
+
+    //B = Q^dagger*M = transpose(conj(Q))*M
+    setQc();
+    mult(transpose(Qc),M,B);
+
+    //B = Ub*D*V^dagger so M ~= (Q*Ub)*D*V^dagger
+    SVDRef(makeRefc(B),Ub,D,V,thresh,method);
+    mult(Q,Ub,U);
+    }
+template void randomizedSVDRef(MatRefc<Real> const&,MatRef<Real> const&, VectorRef const&, MatRef<Real> const&,long,SVDMethod,Real);
+template void randomizedSVDRef(MatRefc<Cplx> const&,MatRef<Cplx> const&, VectorRef const&, MatRef<Cplx> const&,long,SVDMethod,Real);
+
 
 
 //void
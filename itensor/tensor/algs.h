@@ -16,12 +16,32 @@
 #ifndef __ITENSOR_MATRIX_ALGS__H_
 #define __ITENSOR_MATRIX_ALGS__H_
 
+#include <string>
 #include "itensor/tensor/slicemat.h"
 
 namespace itensor {
 
 static const Real SVD_THRESH = 1E-5;
 
+//
+// Algorithm used by SVD/SVDRef:
+//
+// o Recursive: diagonalize M*M^dagger, then
+//   redo the SVD of the part of the spectrum
+//   with small singular values (default)
+// o Gesdd: LAPACK divide-and-conquer SVD
+// o Gesvd: LAPACK QR-iteration SVD
+//
+// If a LAPACK routine fails to converge
+// the Recursive method is used instead.
+//
+enum class SVDMethod { Recursive, Gesdd, Gesvd };
+
+//Convert "recursive", "gesdd", or "gesvd"
+//(the values of the "SVDMethod" arg) to a SVDMethod
+SVDMethod
+toSVDMethod(std::string const& name);
+
 //
 // diagHermitian diagonalizes a
 // Hermitian (and/or real symmetric) matrix M 
@@ -114,8 +134,30 @@ SVD(MatM && M,
     MatU && U, 
     VecD && D, 
     MatV && V,
-    Real thresh = SVD_THRESH);
+    Real thresh = SVD_THRESH,
+    SVDMethod method = SVDMethod::Recursive);
+
 
+//
+// Randomized SVD (range finder of Halko, Martinsson,
+// and Tropp): computes only the leading ncols(U)
+// singular values D and vectors U, V of M, with
+// U and V sized nrows(M) x ncols(U) and ncols(M) x ncols(U).
+// M is multiplied by a random block of vectors,
+// refined by niter power iterations, and the SVD of
+// the small projected matrix is done by SVDRef with
+// the given method. The random block uses a fixed seed
+// so results are reproducible.
+//
+template<typename T>
+void
+randomizedSVDRef(MatRefc<T> const& M,
+                 MatRef<T>  const& U, 
+                 VectorRef  const& D, 
+                 MatRef<T>  const& V,
+                 long niter = 2,
+                 SVDMethod method = SVDMethod::Gesdd,
+                 Real thresh = SVD_THRESH);
 
 } //namespace itensor
 
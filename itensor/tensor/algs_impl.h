@@ -168,6 +168,15 @@ SVDRef(MatRefc<T> const& M,
        MatRef<T>  const& V,
        Real thresh);
 
+template<typename T>
+void
+SVDRef(MatRefc<T> const& M,
+       MatRef<T>  const& U, 
+       VectorRef  const& D, 
+       MatRef<T>  const& V,
+       Real thresh,
+       SVDMethod method);
+
 template<class MatM, 
          class MatU,
          class VecD,
@@ -178,7 +187,8 @@ SVD(MatM && M,
     MatU && U, 
     VecD && D, 
     MatV && V,
-    Real thresh)
+    Real thresh,
+    SVDMethod method)
     {
     auto Mr = nrows(M),
          Mc = ncols(M);
@@ -186,7 +196,7 @@ SVD(MatM && M,
     resize(U,Mr,nsv);
     resize(V,Mc,nsv);
     resize(D,nsv);
-    SVDRef(makeRef(M),makeRef(U),makeRef(D),makeRef(V),thresh);
+    SVDRef(makeRef(M),makeRef(U),makeRef(D),makeRef(V),thresh,method);
     }
 
 } //namespace itensor
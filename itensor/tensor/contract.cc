@@ -14,11 +14,16 @@
 // limitations under the License.
 //
 //TODO: replace unordered_map with a simpler container (small_map? or jump directly to location?)
+#include <cstdlib>
 #include <unordered_map>
-#include <future>
+#include <atomic>
+#include <algorithm>
 
 #include "itensor/util/multalloc.h"
 #include "itensor/util/cputime.h"
+#include "itensor/util/threadpool.h"
+#include "itensor/util/lrucache.h"
+#include "itensor/util/scratch.h"
 #include "itensor/detail/algs.h"
 #include "itensor/detail/gcounter.h"
 #include "itensor/tensor/mat.h"
@@ -658,6 +663,10 @@ struct ABoffC
 
     void
     execute() const { multAdd(mA,mB,mC); }
+
+    //Estimated cost (m*n*k) of this GEMM
+    double
+    flops() const { return double(nrows(mA))*double(ncols(mB))*double(ncols(mA)); }
     };
 
 class CABqueue
@@ -677,58 +686,130 @@ class CABqueue
         }
 
     void 
-    run(int numthread)
+    run(ThreadPool & pool)
         {
-
-        //////////
-        ////Analyze tasks:
-        //println("number of distinct offCs is ",subtask.size());
-        //int ttasks = 0;
-        //for(auto& st : subtask) ttasks += st.second.size();
-        //println("number of distinct tasks is ",ttasks);
-        //size_t maxj = 0;
-        //for(const auto& st : subtask)
-        //    maxj = std::max(st.second.size(),maxj);
-        //println("max subtask size is ",maxj);
-        //////////
-
-        //Loop over threads in a round-robin fashion.
-        //Assign all tasks with the same memory 
-        //destination (offC) to the same thread. 
-        vector<vector<ABoffC>> threadtask(numthread);
-        int ss = 0;
+        //All tasks with the same memory 
+        //destination (offC) go into one pool task,
+        //weighted by its total estimated flops so
+        //the pool can balance the load
+        auto tasks = vector<ThreadPool::Task>{};
+        auto costs = vector<double>{};
+        tasks.reserve(subtask.size());
+        costs.reserve(subtask.size());
         for(auto& t : subtask)
             {
             auto& st_tasks = t.second;
-            auto& tt = threadtask[ss];
-            std::move(st_tasks.begin(),st_tasks.end(),std::inserter(tt,tt.end()));
-            ss = (ss+1)%numthread;
+            auto cost = 0.;
+            for(auto const& task : st_tasks) cost += task.flops();
+            tasks.emplace_back([&st_tasks]()
+                {
+                for(auto const& task : st_tasks)
+                    task.execute();
+                });
+            costs.push_back(cost);
             }
+        pool.run(tasks,costs);
+        }
+    };
+
 
-        //"Package" thread tasks into std::future objects
-        //which begin running once they are created
-        vector<std::future<void>> futs(numthread);
-        assert(threadtask.size()==futs.size());
-        for(size_t i = 0; i < futs.size(); ++i)
+//Number of threads to use for a contraction
+//with properties p (see setContractParallelSize)
+static int
+contractNThread(CProps const& p)
+    {
+    auto size = getContractParallelSize();
+    if(size < 0) return 1;
+    auto flops = double(p.dleft)*double(p.dmid)*double(p.dright);
+    if(flops < double(size)) return 1;
+    return getNThread();
+    }
+
+//Same as gemm(A,B,C,alpha,beta), with the product split
+//over up to nthread threads along the (uncontracted)
+//columns or rows of C, whichever there are more of
+template<typename VA, typename VB, typename VC>
+void
+parallelGemm(MatRefc<VA> A,
+             MatRefc<VB> B,
+             MatRef<VC> C,
+             Real alpha,
+             Real beta,
+             int nthread)
+    {
+    if(!isNormal(C.range()))
+        {
+        //C^T = B^T A^T with C^T a column-major matrix
+        parallelGemm(transpose(B),transpose(A),transpose(C),alpha,beta,nthread);
+        return;
+        }
+    auto m = nrows(A),
+         k = ncols(A),
+         n = ncols(B);
+    auto& pool = threadPool();
+    if(n >= m)
+        {
+        //Columns of C are contiguous; columns of B are
+        //copied into a buffer if B is stored transposed
+        auto nchunk = std::min(size_t(nthread),n);
+        parallelFor(pool,vector<double>(nchunk,1.),nchunk,[&](size_t c)
             {
-            auto& tt = threadtask[i];
-            //printfln("task size for thread %d is %d",i,tt.size());
-            futs[i] = std::async(std::launch::async,
-                      [&tt]()
-                          { 
-                          for(const auto& task : tt)
-                            task.execute();
-                          }
-                      );
-            }
-        //Wait for futures to complete
-        for(auto& ft : futs) 
+            auto j0 = (n*c)/nchunk,
+                 j1 = (n*(c+1))/nchunk;
+            auto Cj = columns(C,j0,j1);
+            auto Bj = columns(B,j0,j1);
+            if(isContiguous(Bj.range()))
+                {
+                gemm(A,Bj,Cj,alpha,beta);
+                return;
+                }
+            auto nb = j1-j0;
+            auto buf = ScratchBuffer<VB>(k*nb);
+            auto Bb = makeMatRef(buf.data(),buf.size(),k,nb);
+            for(auto j : range(nb))
+            for(auto i : range(k))
+                {
+                Bb(i,j) = Bj(i,j);
+                }
+            gemm(A,makeRefc(Bb),Cj,alpha,beta);
+            });
+        }
+    else
+        {
+        //Rows of C are strided: each thread computes its
+        //rows into a buffer and adds them into C
+        auto nchunk = std::min(size_t(nthread),m);
+        parallelFor(pool,vector<double>(nchunk,1.),nchunk,[&](size_t c)
             {
-            ft.wait();
-            }
+            auto i0 = (m*c)/nchunk,
+                 i1 = (m*(c+1))/nchunk,
+                 mb = i1-i0;
+            auto Ai = rows(A,i0,i1);
+            auto abuf = ScratchBuffer<VA>{};
+            if(!isContiguous(Ai.range()))
+                {
+                abuf = ScratchBuffer<VA>(mb*k);
+                auto Ab = makeMatRef(abuf.data(),abuf.size(),mb,k);
+                for(auto j : range(k))
+                for(auto i : range(mb))
+                    {
+                    Ab(i,j) = Ai(i,j);
+                    }
+                Ai = makeRefc(Ab);
+                }
+            auto cbuf = ScratchBuffer<VC>(mb*n);
+            auto Cb = makeMatRef(cbuf.data(),cbuf.size(),mb,n);
+            gemm(Ai,B,Cb,1.,0.);
+            auto Ci = rows(C,i0,i1);
+            for(auto j : range(n))
+            for(auto i : range(mb))
+                {
+                auto& el = Ci(i,j);
+                el = (beta == 0.) ? alpha*Cb(i,j) : alpha*Cb(i,j)+beta*el;
+                }
+            });
         }
-    };
-
+    }
 
 template<typename range_t, typename VA, typename VB>
 void 
@@ -740,6 +821,7 @@ contract(CProps const& p,
          Real beta = 0.)
     {
     using VC = common_type<VA,VB>;
+    auto nthread = contractNThread(p);
     auto Apsize = p.permuteA() ? dim(p.newArange) : 0ul;
     auto Bpsize = p.permuteB() ? dim(p.newBrange) : 0ul;
     auto Cpsize = p.permuteC() ? dim(p.newCrange) : 0ul;
@@ -747,7 +829,11 @@ contract(CProps const& p,
     auto Bbufsize = isCplx(B) ? 2ul*Bpsize : Bpsize;
     auto Cbufsize = isCplx(C) ? 2ul*Cpsize : Cpsize;
 
-    auto d = std::vector<Real>(Abufsize+Bbufsize+Cbufsize);
+    //Buffers for permuted A, B, and C come from the
+    //scratch arena; the C part starts out zeroed as
+    //gemm reads it when beta != 0
+    auto d = ScratchBuffer<Real>(Abufsize+Bbufsize+Cbufsize);
+    if(beta != 0.) std::fill(d.data()+Abufsize+Bbufsize,d.data()+d.size(),0.);
     auto ab = MAKE_SAFE_PTR(d.data(),d.size());
     auto bb = ab+Abufsize;
     auto cb = bb+Bbufsize;
@@ -817,7 +903,8 @@ contract(CProps const& p,
         }
 
     TIMER_START(31);
-    gemm(aref,bref,cref,alpha,beta);
+    if(nthread > 1) parallelGemm(aref,bref,cref,alpha,beta,nthread);
+    else            gemm(aref,bref,cref,alpha,beta);
     TIMER_STOP(31);
 
     if(p.permuteC())
@@ -831,6 +918,171 @@ contract(CProps const& p,
         }
     }
 
+//
+// Packed contraction engine (ContractMethod::Packed)
+//
+// Views A as a matrix A(r,k) and B as B(k,c), where
+// r runs over the uncontracted indices of A, k over the
+// contracted indices and c over the uncontracted indices
+// of B. Rather than permuting A and B into full copies,
+// panels of these matrices are copied straight from their
+// strided layout into small contiguous buffers, multiplied
+// with gemm, and the product panel is added into C
+// wherever the matching elements of C live.
+//
+const long CONTRACT_PANEL_M = 128,
+           CONTRACT_PANEL_N = 512,
+           CONTRACT_PANEL_K = 256;
+
+//Offsets of all values of a multi-index having the
+//given extents (first index fastest) with respect
+//to two different sets of strides
+void
+multiIndexOffsets(vector<long> const& ext,
+                  vector<long> const& str1,
+                  vector<long> const& str2,
+                  vector<long> & off1,
+                  vector<long> & off2)
+    {
+    long size = 1;
+    for(auto e : ext) size *= e;
+    off1.resize(size);
+    off2.resize(size);
+    auto ind = vector<long>(ext.size(),0);
+    long o1 = 0,
+         o2 = 0;
+    for(long n = 0; n < size; ++n)
+        {
+        off1[n] = o1;
+        off2[n] = o2;
+        for(decltype(ext.size()) j = 0; j < ext.size(); ++j)
+            {
+            ++ind[j];
+            o1 += str1[j];
+            o2 += str2[j];
+            if(ind[j] < ext[j]) break;
+            o1 -= ind[j]*str1[j];
+            o2 -= ind[j]*str2[j];
+            ind[j] = 0;
+            }
+        }
+    }
+
+template<typename range_t, typename VA, typename VB>
+void 
+contractPacked(TenRefc<range_t,VA> A, Labels const& ai,
+               TenRefc<range_t,VB> B, Labels const& bi,
+               TenRef<range_t,common_type<VA,VB>>  C, Labels const& ci,
+               Real alpha,
+               Real beta)
+    {
+    using VC = common_type<VA,VB>;
+
+    //Extents and strides of the row (r), contracted (k)
+    //and column (c) multi-indices, taken in the index order
+    //of A (r and k) or B (c) so that the innermost packing
+    //loops follow the memory layout of A and B
+    vector<long> rext,rstrA,rstrC,
+                 kext,kstrA,kstrB,
+                 cext,cstrB,cstrC;
+    for(auto i : range(ai))
+        {
+        auto j = find_index(bi,ai[i]);
+        if(j >= 0)
+            {
+            kext.push_back(A.extent(i));
+            kstrA.push_back(A.stride(i));
+            kstrB.push_back(B.stride(j));
+            continue;
+            }
+        auto l = find_index(ci,ai[i]);
+        if(l < 0) Error("contractPacked: uncontracted index of A not found in C");
+        rext.push_back(A.extent(i));
+        rstrA.push_back(A.stride(i));
+        rstrC.push_back(C.stride(l));
+        }
+    for(auto j : range(bi))
+        {
+        if(find_index(ai,bi[j]) >= 0) continue;
+        auto l = find_index(ci,bi[j]);
+        if(l < 0) Error("contractPacked: uncontracted index of B not found in C");
+        cext.push_back(B.extent(j));
+        cstrB.push_back(B.stride(j));
+        cstrC.push_back(C.stride(l));
+        }
+
+    vector<long> rA,rC,kA,kB,cB,cC;
+    multiIndexOffsets(rext,rstrA,rstrC,rA,rC);
+    multiIndexOffsets(kext,kstrA,kstrB,kA,kB);
+    multiIndexOffsets(cext,cstrB,cstrC,cB,cC);
+    auto M = long(rA.size()),
+         K = long(kA.size()),
+         N = long(cB.size());
+
+    auto pa = A.data();
+    auto pb = B.data();
+    auto pc = C.data();
+
+    //Apply beta to C up front so that
+    //panels can simply be added in
+    if(beta != 1.)
+        {
+        for(auto c : range(N))
+        for(auto r : range(M))
+            {
+            auto& el = pc[rC[r]+cC[c]];
+            el = (beta == 0.) ? VC(0.) : beta*el;
+            }
+        }
+
+    auto Ap = ScratchBuffer<VA>(CONTRACT_PANEL_M*CONTRACT_PANEL_K);
+    auto Bp = ScratchBuffer<VB>(CONTRACT_PANEL_K*CONTRACT_PANEL_N);
+    auto Cp = ScratchBuffer<VC>(CONTRACT_PANEL_M*CONTRACT_PANEL_N);
+
+    for(long c0 = 0; c0 < N; c0 += CONTRACT_PANEL_N)
+        {
+        auto nb = std::min(CONTRACT_PANEL_N,N-c0);
+        for(long k0 = 0; k0 < K; k0 += CONTRACT_PANEL_K)
+            {
+            auto kb = std::min(CONTRACT_PANEL_K,K-k0);
+            TIMER_START(32);
+            for(long c = 0; c < nb; ++c)
+                {
+                auto pbc = pb+cB[c0+c];
+                auto* bp = Bp.data()+kb*c;
+                for(long k = 0; k < kb; ++k) bp[k] = pbc[kB[k0+k]];
+                }
+            TIMER_STOP(32);
+            auto bref = makeMatRefc(Bp.data(),Bp.size(),kb,nb);
+            for(long r0 = 0; r0 < M; r0 += CONTRACT_PANEL_M)
+                {
+                auto mb = std::min(CONTRACT_PANEL_M,M-r0);
+                TIMER_START(32);
+                for(long k = 0; k < kb; ++k)
+                    {
+                    auto pak = pa+kA[k0+k];
+                    auto* ap = Ap.data()+mb*k;
+                    for(long r = 0; r < mb; ++r) ap[r] = pak[rA[r0+r]];
+                    }
+                TIMER_STOP(32);
+                auto aref = makeMatRefc(Ap.data(),Ap.size(),mb,kb);
+                auto cref = makeMatRef(Cp.data(),Cp.size(),mb,nb);
+                TIMER_START(31);
+                gemm(aref,bref,cref,alpha,0.);
+                TIMER_STOP(31);
+                TIMER_START(32);
+                for(long c = 0; c < nb; ++c)
+                    {
+                    auto pcc = pc+cC[c0+c];
+                    auto* cp = Cp.data()+mb*c;
+                    for(long r = 0; r < mb; ++r) pcc[rC[r0+r]] += cp[r];
+                    }
+                TIMER_STOP(32);
+                }
+            }
+        }
+    }
+
 template<typename R, typename T1, typename T2>
 void 
 contractScalar(T1 a, 
@@ -848,6 +1100,96 @@ contractScalar(T1 a,
         transform(PB,C,[fac,beta](T2 b, T3& c){ c = fac*b+beta*c; });
     }
 
+//
+// Cache of CProps ("contraction plans") keyed on
+// the labels and extents of A, B, and C, so that
+// repeated contractions of the same shape
+// (as in DMRG sweeps) skip CProps::compute.
+// One cache per thread, since contract may be
+// called from the tasks of a ThreadPool.
+//
+const size_t CONTRACT_PLAN_CACHE_SIZE = 128;
+
+static CacheCounters&
+contractPlanCounters()
+    {
+    static CacheCounters counters;
+    return counters;
+    }
+
+using CPropsCache = LRUCache<PlanKey,std::shared_ptr<const CProps>,PlanKeyHash>;
+
+static CPropsCache&
+contractPlanCache()
+    {
+    thread_local CPropsCache cache(CONTRACT_PLAN_CACHE_SIZE);
+    return cache;
+    }
+
+CacheStats
+contractPlanCacheStats() { return CacheStats(contractPlanCounters()); }
+
+void
+clearContractPlanCache()
+    {
+    contractPlanCache().clear();
+    contractPlanCounters().hits = 0;
+    contractPlanCounters().misses = 0;
+    }
+
+template<typename RangeT, typename VA, typename VB>
+PlanKey
+contractPlanKey(TenRefc<RangeT,VA> const& A, Labels const& ai, 
+                TenRefc<RangeT,VB> const& B, Labels const& bi, 
+                TenRef<RangeT,common_type<VA,VB>> const& C, Labels const& ci)
+    {
+    auto key = PlanKey{};
+    key.push_back(ai.size());
+    key.push_back(bi.size());
+    key.push_back(ci.size());
+    for(auto l : ai) key.push_back(l);
+    for(auto l : bi) key.push_back(l);
+    for(auto l : ci) key.push_back(l);
+    for(auto n : range(ai.size())) key.push_back(A.extent(n));
+    for(auto n : range(bi.size())) key.push_back(B.extent(n));
+    for(auto n : range(ci.size())) key.push_back(C.extent(n));
+    return key;
+    }
+
+static std::atomic<int>&
+contractMethodFlag()
+    {
+    static std::atomic<int> method{int(ContractMethod::Permute)};
+    return method;
+    }
+
+ContractMethod
+getContractMethod() { return ContractMethod(contractMethodFlag().load()); }
+
+void
+setContractMethod(ContractMethod method) { contractMethodFlag() = int(method); }
+
+static long
+defaultContractParallelSize()
+    {
+    auto env = std::getenv("ITENSOR_CONTRACT_PARALLEL_SIZE");
+    if(env) return std::atol(env);
+    return 1l << 21;
+    }
+
+static std::atomic<long>&
+contractParallelSizeFlag()
+    {
+    static std::atomic<long> size{defaultContractParallelSize()};
+    return size;
+    }
+
+long
+getContractParallelSize() { return contractParallelSizeFlag().load(); }
+
+void
+setContractParallelSize(long size) { contractParallelSizeFlag() = size; }
+
 template<typename RangeT, typename VA, typename VB>
 void 
 contract(TenRefc<RangeT,VA> A, Labels const& ai, 
@@ -857,6 +1199,19 @@ contract(TenRefc<RangeT,VA> A, Labels const& ai,
          Real alpha,
          Real beta)
     {
+    contract(A,ai,B,bi,C,ci,alpha,beta,getContractMethod());
+    }
+
+template<typename RangeT, typename VA, typename VB>
+void 
+contract(TenRefc<RangeT,VA> A, Labels const& ai, 
+         TenRefc<RangeT,VB> B, Labels const& bi, 
+         TenRef<RangeT,common_type<VA,VB>>  C, 
+         Labels const& ci,
+         Real alpha,
+         Real beta,
+         ContractMethod method)
+    {
     if(ai.empty()) 
         {
         contractScalar(*A.data(),B,bi,C,ci,alpha,beta);
@@ -867,9 +1222,35 @@ contract(TenRefc<RangeT,VA> A, Labels const& ai,
         }
     else
         {
-        CProps props(ai,bi,ci);
-        props.compute(A,B,C);
-        contract(props,A,B,C,alpha,beta);
+        auto key = contractPlanKey(A,ai,B,bi,C,ci);
+        auto& cache = contractPlanCache();
+        auto* cached = cache.find(key);
+        std::shared_ptr<const CProps> props;
+        if(cached)
+            {
+            ++contractPlanCounters().hits;
+            props = *cached;
+            }
+        else
+            {
+            ++contractPlanCounters().misses;
+            auto newprops = std::make_shared<CProps>(ai,bi,ci);
+            newprops->compute(A,B,C);
+            cache.insert(key,newprops);
+            props = newprops;
+            }
+        auto& p = *props;
+        //Packing only pays off when something
+        //would otherwise have to be permuted
+        if(method == ContractMethod::Packed 
+           && (p.permuteA() || p.permuteB() || p.permuteC()))
+            {
+            contractPacked(A,ai,B,bi,C,ci,alpha,beta);
+            }
+        else
+            {
+            contract(p,A,B,C,alpha,beta);
+            }
         }
     }
 
@@ -914,6 +1295,46 @@ contract(TenRefc<IndexSet,Cplx>, Labels const&,
          TenRefc<IndexSet,Cplx>, Labels const&, 
          TenRef<IndexSet,Cplx> , Labels const&,
          Real,Real);
+template void 
+contract(TenRefc<Range,Real>, Labels const&, 
+         TenRefc<Range,Real>, Labels const&, 
+         TenRef<Range,Real> , Labels const&,
+         Real,Real,ContractMethod);
+template void 
+contract(TenRefc<Range,Cplx>, Labels const&, 
+         TenRefc<Range,Real>, Labels const&, 
+         TenRef<Range,Cplx> , Labels const&,
+         Real,Real,ContractMethod);
+template void 
+contract(TenRefc<Range,Real>, Labels const&, 
+         TenRefc<Range,Cplx>, Labels const&, 
+         TenRef<Range,Cplx> , Labels const&,
+         Real,Real,ContractMethod);
+template void 
+contract(TenRefc<Range,Cplx>, Labels const&, 
+         TenRefc<Range,Cplx>, Labels const&, 
+         TenRef<Range,Cplx> , Labels const&,
+         Real,Real,ContractMethod);
+template void 
+contract(TenRefc<IndexSet,Real>, Labels const&, 
+         TenRefc<IndexSet,Real>, Labels const&, 
+         TenRef<IndexSet,Real> , Labels const&,
+         Real,Real,ContractMethod);
+template void 
+contract(TenRefc<IndexSet,Cplx>, Labels const&, 
+         TenRefc<IndexSet,Real>, Labels const&, 
+         TenRef<IndexSet,Cplx> , Labels const&,
+         Real,Real,ContractMethod);
+template void 
+contract(TenRefc<IndexSet,Real>, Labels const&, 
+         TenRefc<IndexSet,Cplx>, Labels const&, 
+         TenRef<IndexSet,Cplx> , Labels const&,
+         Real,Real,ContractMethod);
+template void 
+contract(TenRefc<IndexSet,Cplx>, Labels const&, 
+         TenRefc<IndexSet,Cplx>, Labels const&, 
+         TenRef<IndexSet,Cplx> , Labels const&,
+         Real,Real,ContractMethod);
 
 
 struct MultInfo
@@ -1013,8 +1434,6 @@ contractloop(TenRefc<RangeT> A, Labels const& ai,
         }
     p.computePerms();
 
-    auto nthread = args.getInt("NThread",4);
-
     long ra = ai.size(),
          rb = bi.size(),
          rc = ci.size();
@@ -1105,7 +1524,7 @@ contractloop(TenRefc<RangeT> A, Labels const& ai,
                 }
             }
         }
-    cabq.run(nthread);
+    cabq.run(threadPool());
     }
 template
 void 
@@ -19,10 +19,67 @@
 #include "itensor/tensor/vec.h"
 #include "itensor/util/args.h"
 #include "itensor/util/iterate.h"
+#include "itensor/util/lrucache.h"
 #include "itensor/detail/gcounter.h"
 
 namespace itensor {
 
+//
+// contract caches its analysis of each
+// contraction (index matching, permutations,
+// GEMM dimensions) keyed on the labels and
+// extents of A, B, and C. These report the
+// hits and misses over all threads so far, and
+// clear the cache of the calling thread.
+//
+CacheStats
+contractPlanCacheStats();
+
+void
+clearContractPlanCache();
+
+//
+// Algorithm used by contract when A, B, or C
+// is not already laid out as a matrix:
+//
+// o Permute: permute A, B (and C) into full
+//   temporary copies, then call gemm once
+// o Packed: copy GEMM-sized panels of A and B
+//   straight from their strided layout and add
+//   each panel of the product into C, so no
+//   permuted copy of a whole tensor is made
+//
+// The version of contract without a method
+// argument uses the global default (initially
+// Permute) set by setContractMethod.
+//
+enum class ContractMethod { Permute, Packed };
+
+ContractMethod
+getContractMethod();
+
+void
+setContractMethod(ContractMethod method);
+
+//
+// Dense contractions done by permuting (the
+// Permute method, or when nothing needs permuting)
+// use all threads of threadPool() once they take
+// at least getContractParallelSize() multiply-adds
+// (dleft*dmid*dright): the matrix product is split
+// along the uncontracted rows or columns of the result.
+// (Large permuted copies are split over threads by
+// transform, see permutekernel.h.)
+// The default size is 2^21, or the value of the
+// environment variable ITENSOR_CONTRACT_PARALLEL_SIZE;
+// a negative size always contracts on one thread.
+//
+long
+getContractParallelSize();
+
+void
+setContractParallelSize(long size);
+
 template<typename RangeT, typename VA, typename VB>
 void 
 contract(TenRefc<RangeT,VA> A, Labels const& ai, 
@@ -32,6 +89,16 @@ contract(TenRefc<RangeT,VA> A, Labels const& ai,
          Real alpha = 1.,
          Real beta = 0.);
 
+template<typename RangeT, typename VA, typename VB>
+void 
+contract(TenRefc<RangeT,VA> A, Labels const& ai, 
+         TenRefc<RangeT,VB> B, Labels const& bi, 
+         TenRef<RangeT,common_type<VA,VB>>  C, 
+         Labels const& ci,
+         Real alpha,
+         Real beta,
+         ContractMethod method);
+
 template<typename R, typename VA, typename VB>
 void 
 contract(Ten<R,VA> const& A, Labels const& ai, 
@@ -13,9 +13,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
+#include <atomic>
+#include <cstdlib>
 #include "itensor/tensor/lapack_wrap.h"
 #include "itensor/tensor/slicemat.h"
 #include "itensor/util/safe_ptr.h"
+#include "itensor/util/scratch.h"
 
 namespace itensor {
 
@@ -98,7 +101,9 @@ gemm_emulator(MatRefc<VA> A,
     auto Brd = SAFE_REINTERPRET(const Real,Bd);
     auto Crd = SAFE_REINTERPRET(Real,Cd);
 
-    auto d = std::vector<Real>(Abufsize+Bbufsize+Cbufsize);
+    //The C part need not be initialized: the first task
+    //for each part of C either copies C in or has beta == 0
+    auto d = ScratchBuffer<Real>(Abufsize+Bbufsize+Cbufsize);
     auto pd = MAKE_SAFE_PTR(d.data(),d.size());
     auto ab = pd;
     auto ae = ab+Abufsize;
@@ -162,6 +167,103 @@ gemm_emulator(MatRefc<VA> A,
         }
     }
 
+//
+// 3M method: with A = Ar + i*Ai and B = Br + i*Bi,
+//   T1 = Ar*Br, T2 = Ai*Bi, T3 = (Ar+Ai)*(Br+Bi)
+//   A*B = (T1-T2) + i*(T3-T1-T2)
+// which takes three real multiplications instead of four
+//
+void
+gemm_3m(MatRefc<Cplx> A,
+        MatRefc<Cplx> B,
+        MatRef<Cplx>  C,
+        Real alpha,
+        Real beta)
+    {
+    auto Asize = A.size(),
+         Bsize = B.size(),
+         Csize = C.size();
+    auto d = ScratchBuffer<Real>(2*(Asize+Bsize)+3*Csize);
+    auto ar = d.data(),
+         ai = ar+Asize,
+         br = ai+Asize,
+         bi = br+Bsize,
+         t1 = bi+Bsize,
+         t2 = t1+Csize,
+         t3 = t2+Csize;
+
+    auto Ad = A.data();
+    for(decltype(Asize) n = 0; n < Asize; ++n)
+        {
+        ar[n] = Ad[n].real();
+        ai[n] = Ad[n].imag();
+        }
+    auto Bd = B.data();
+    for(decltype(Bsize) n = 0; n < Bsize; ++n)
+        {
+        br[n] = Bd[n].real();
+        bi[n] = Bd[n].imag();
+        }
+
+    auto realMult = [&A,&B](Real const* pa, Real const* pb, Real* pc)
+        {
+        gemm_wrapper(isTransposed(A),
+                     isTransposed(B),
+                     nrows(A),
+                     ncols(B),
+                     ncols(A),
+                     1.,
+                     pa,
+                     pb,
+                     0.,
+                     pc);
+        };
+    realMult(ar,br,t1);
+    realMult(ai,bi,t2);
+    for(decltype(Asize) n = 0; n < Asize; ++n) ar[n] += ai[n];
+    for(decltype(Bsize) n = 0; n < Bsize; ++n) br[n] += bi[n];
+    realMult(ar,br,t3);
+
+    auto Cd = C.data();
+    for(decltype(Csize) n = 0; n < Csize; ++n)
+        {
+        auto z = Cplx(alpha*(t1[n]-t2[n]),alpha*(t3[n]-t1[n]-t2[n]));
+        Cd[n] = (beta == 0.) ? z : beta*Cd[n]+z;
+        }
+    }
+
+static std::atomic<int>&
+zgemmMethodFlag()
+    {
+    static std::atomic<int> method{int(ZGemmMethod::Auto)};
+    return method;
+    }
+
+ZGemmMethod
+getZGemmMethod() { return ZGemmMethod(zgemmMethodFlag().load()); }
+
+void
+setZGemmMethod(ZGemmMethod method) { zgemmMethodFlag() = int(method); }
+
+static std::atomic<long>&
+zgemm3MSize()
+    {
+    //Default m*n*k where 3M starts to pay off
+    //for optimized BLAS libraries
+    static std::atomic<long> size{[]()
+        {
+        auto env = std::getenv("ITENSOR_ZGEMM_3M_SIZE");
+        return env ? std::atol(env) : 512l*512l*512l;
+        }()};
+    return size;
+    }
+
+long
+getZGemm3MSize() { return zgemm3MSize().load(); }
+
+void
+setZGemm3MSize(long size) { zgemm3MSize() = size; }
+
 void
 gemm_impl(MatRefc<Cplx> A,
           MatRefc<Cplx> B,
@@ -169,29 +271,54 @@ gemm_impl(MatRefc<Cplx> A,
           Real alpha,
           Real beta)
     {
+    auto method = getZGemmMethod();
+    if(method == ZGemmMethod::Auto)
+        {
+        auto size = double(nrows(A))*ncols(B)*ncols(A);
+        if(size >= double(getZGemm3MSize()))
+            {
+            method = ZGemmMethod::ThreeM;
+            }
+        else
+            {
 #ifdef ITENSOR_USE_ZGEMM
-    gemm_wrapper(isTransposed(A),
-                 isTransposed(B),
-                 nrows(A),
-                 ncols(B),
-                 ncols(A),
-                 alpha,
-                 A.data(),
-                 B.data(),
-                 beta,
-                 C.data());
-#else //emulate zgemm by calling dgemm four times
-    std::array<const dgemmTask,6> 
-    tasks = 
-        {{dgemmTask(0,0,0,+alpha,beta),
-          dgemmTask(1,1,0,-alpha),
-          dgemmTask(0),
-          dgemmTask(1,0,1,+alpha,beta),
-          dgemmTask(0,1,1,+alpha),
-          dgemmTask(1)
-          }};
-    gemm_emulator(A,B,C,alpha,beta,tasks);
+            method = ZGemmMethod::Native;
+#else
+            method = ZGemmMethod::Emulate;
 #endif
+            }
+        }
+
+    if(method == ZGemmMethod::Native)
+        {
+        gemm_wrapper(isTransposed(A),
+                     isTransposed(B),
+                     nrows(A),
+                     ncols(B),
+                     ncols(A),
+                     alpha,
+                     A.data(),
+                     B.data(),
+                     beta,
+                     C.data());
+        }
+    else if(method == ZGemmMethod::ThreeM)
+        {
+        gemm_3m(A,B,C,alpha,beta);
+        }
+    else //emulate zgemm by calling dgemm four times
+        {
+        std::array<const dgemmTask,6> 
+        tasks = 
+            {{dgemmTask(0,0,0,+alpha,beta),
+              dgemmTask(1,1,0,-alpha),
+              dgemmTask(0),
+              dgemmTask(1,0,1,+alpha,beta),
+              dgemmTask(0,1,1,+alpha),
+              dgemmTask(1)
+              }};
+        gemm_emulator(A,B,C,alpha,beta,tasks);
+        }
     }
 
 
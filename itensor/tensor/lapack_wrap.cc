@@ -389,6 +389,143 @@ zgesdd_wrapper(char *jobz,           //char* specifying how much of U, V to comp
 #endif
     }
 
+//
+// gesdd / gesvd
+//
+// Workspace sizes come from a query call (lwork = -1)
+//
+LAPACK_INT
+gesdd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              LAPACK_REAL* A,
+              LAPACK_REAL* s,
+              LAPACK_REAL* u,
+              LAPACK_REAL* vt)
+    {
+    char jobz = 'S';
+    LAPACK_INT l = std::min(m,n);
+    LAPACK_INT info = 0;
+    std::vector<LAPACK_INT> iwork(8*l);
+    LAPACK_REAL wsize = 0;
+    LAPACK_INT lwork = -1;
+#ifdef PLATFORM_acml
+    LAPACK_INT jobz_len = 1;
+    F77NAME(dgesdd)(&jobz,&m,&n,A,&m,s,u,&m,vt,&l,&wsize,&lwork,iwork.data(),&info,jobz_len);
+#else
+    F77NAME(dgesdd)(&jobz,&m,&n,A,&m,s,u,&m,vt,&l,&wsize,&lwork,iwork.data(),&info);
+#endif
+    if(info != 0) return info;
+    lwork = LAPACK_INT(wsize);
+    std::vector<LAPACK_REAL> work(lwork);
+#ifdef PLATFORM_acml
+    F77NAME(dgesdd)(&jobz,&m,&n,A,&m,s,u,&m,vt,&l,work.data(),&lwork,iwork.data(),&info,jobz_len);
+#else
+    F77NAME(dgesdd)(&jobz,&m,&n,A,&m,s,u,&m,vt,&l,work.data(),&lwork,iwork.data(),&info);
+#endif
+    return info;
+    }
+
+LAPACK_INT
+gesdd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              Cplx* A,
+              LAPACK_REAL* s,
+              Cplx* u,
+              Cplx* vt)
+    {
+    static_assert(sizeof(LAPACK_COMPLEX)==sizeof(Cplx),"LAPACK_COMPLEX and itensor::Cplx have different size");
+    char jobz = 'S';
+    LAPACK_INT l = std::min(m,n),
+               g = std::max(m,n);
+    LAPACK_INT info = 0;
+    auto pA = reinterpret_cast<LAPACK_COMPLEX*>(A);
+    auto pu = reinterpret_cast<LAPACK_COMPLEX*>(u);
+    auto pvt = reinterpret_cast<LAPACK_COMPLEX*>(vt);
+    std::vector<LAPACK_INT> iwork(8*l);
+    std::vector<LAPACK_REAL> rwork(std::max(5*l*l+5*l,2*g*l+2*l*l+l));
+    Cplx wsize = 0;
+    LAPACK_INT lwork = -1;
+#ifdef PLATFORM_acml
+    LAPACK_INT jobz_len = 1;
+    F77NAME(zgesdd)(&jobz,&m,&n,pA,&m,s,pu,&m,pvt,&l,reinterpret_cast<LAPACK_COMPLEX*>(&wsize),&lwork,rwork.data(),iwork.data(),&info,jobz_len);
+#else
+    F77NAME(zgesdd)(&jobz,&m,&n,pA,&m,s,pu,&m,pvt,&l,reinterpret_cast<LAPACK_COMPLEX*>(&wsize),&lwork,rwork.data(),iwork.data(),&info);
+#endif
+    if(info != 0) return info;
+    lwork = LAPACK_INT(wsize.real());
+    std::vector<LAPACK_COMPLEX> work(lwork);
+#ifdef PLATFORM_acml
+    F77NAME(zgesdd)(&jobz,&m,&n,pA,&m,s,pu,&m,pvt,&l,work.data(),&lwork,rwork.data(),iwork.data(),&info,jobz_len);
+#else
+    F77NAME(zgesdd)(&jobz,&m,&n,pA,&m,s,pu,&m,pvt,&l,work.data(),&lwork,rwork.data(),iwork.data(),&info);
+#endif
+    return info;
+    }
+
+LAPACK_INT
+gesvd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              LAPACK_REAL* A,
+              LAPACK_REAL* s,
+              LAPACK_REAL* u,
+              LAPACK_REAL* vt)
+    {
+    char job = 'S';
+    LAPACK_INT l = std::min(m,n);
+    LAPACK_INT info = 0;
+    LAPACK_REAL wsize = 0;
+    LAPACK_INT lwork = -1;
+#ifdef PLATFORM_acml
+    LAPACK_INT job_len = 1;
+    F77NAME(dgesvd)(&job,&job,&m,&n,A,&m,s,u,&m,vt,&l,&wsize,&lwork,&info,job_len,job_len);
+#else
+    F77NAME(dgesvd)(&job,&job,&m,&n,A,&m,s,u,&m,vt,&l,&wsize,&lwork,&info);
+#endif
+    if(info != 0) return info;
+    lwork = LAPACK_INT(wsize);
+    std::vector<LAPACK_REAL> work(lwork);
+#ifdef PLATFORM_acml
+    F77NAME(dgesvd)(&job,&job,&m,&n,A,&m,s,u,&m,vt,&l,work.data(),&lwork,&info,job_len,job_len);
+#else
+    F77NAME(dgesvd)(&job,&job,&m,&n,A,&m,s,u,&m,vt,&l,work.data(),&lwork,&info);
+#endif
+    return info;
+    }
+
+LAPACK_INT
+gesvd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              Cplx* A,
+              LAPACK_REAL* s,
+              Cplx* u,
+              Cplx* vt)
+    {
+    char job = 'S';
+    LAPACK_INT l = std::min(m,n);
+    LAPACK_INT info = 0;
+    auto pA = reinterpret_cast<LAPACK_COMPLEX*>(A);
+    auto pu = reinterpret_cast<LAPACK_COMPLEX*>(u);
+    auto pvt = reinterpret_cast<LAPACK_COMPLEX*>(vt);
+    std::vector<LAPACK_REAL> rwork(5*l);
+    Cplx wsize = 0;
+    LAPACK_INT lwork = -1;
+#ifdef PLATFORM_acml
+    LAPACK_INT job_len = 1;
+    F77NAME(zgesvd)(&job,&job,&m,&n,pA,&m,s,pu,&m,pvt,&l,reinterpret_cast<LAPACK_COMPLEX*>(&wsize),&lwork,rwork.data(),&info,job_len,job_len);
+#else
+    F77NAME(zgesvd)(&job,&job,&m,&n,pA,&m,s,pu,&m,pvt,&l,reinterpret_cast<LAPACK_COMPLEX*>(&wsize),&lwork,rwork.data(),&info);
+#endif
+    if(info != 0) return info;
+    lwork = LAPACK_INT(wsize.real());
+    std::vector<LAPACK_COMPLEX> work(lwork);
+#ifdef PLATFORM_acml
+    F77NAME(zgesvd)(&job,&job,&m,&n,pA,&m,s,pu,&m,pvt,&l,work.data(),&lwork,rwork.data(),&info,job_len,job_len);
+#else
+    F77NAME(zgesvd)(&job,&job,&m,&n,pA,&m,s,pu,&m,pvt,&l,work.data(),&lwork,rwork.data(),&info);
+#endif
+    return info;
+    }
+
 //
 // dgeqrf
 //
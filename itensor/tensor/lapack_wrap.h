@@ -308,6 +308,31 @@ void F77NAME(zgesdd)(char *jobz, LAPACK_INT *m, LAPACK_INT *n, LAPACK_COMPLEX *a
              LAPACK_COMPLEX *work, LAPACK_INT *lwork, double *rwork, LAPACK_INT *iwork, LAPACK_INT *info);
 #endif
 
+#ifdef PLATFORM_acml
+void F77NAME(dgesdd)(char *jobz, int *m, int *n, double *a, int *lda, double *s, 
+             double *u, int *ldu, double *vt, int *ldvt, 
+             double *work, int *lwork, int *iwork, int *info, 
+             int jobz_len);
+void F77NAME(dgesvd)(char *jobu, char *jobvt, int *m, int *n, double *a, int *lda, double *s, 
+             double *u, int *ldu, double *vt, int *ldvt, 
+             double *work, int *lwork, int *info, 
+             int jobu_len, int jobvt_len);
+void F77NAME(zgesvd)(char *jobu, char *jobvt, int *m, int *n, LAPACK_COMPLEX *a, int *lda, double *s, 
+             LAPACK_COMPLEX *u, int *ldu, LAPACK_COMPLEX *vt, int *ldvt, 
+             LAPACK_COMPLEX *work, int *lwork, double *rwork, int *info, 
+             int jobu_len, int jobvt_len);
+#else
+void F77NAME(dgesdd)(char *jobz, LAPACK_INT *m, LAPACK_INT *n, double *a, LAPACK_INT *lda, double *s, 
+             double *u, LAPACK_INT *ldu, double *vt, LAPACK_INT *ldvt, 
+             double *work, LAPACK_INT *lwork, LAPACK_INT *iwork, LAPACK_INT *info);
+void F77NAME(dgesvd)(char *jobu, char *jobvt, LAPACK_INT *m, LAPACK_INT *n, double *a, LAPACK_INT *lda, double *s, 
+             double *u, LAPACK_INT *ldu, double *vt, LAPACK_INT *ldvt, 
+             double *work, LAPACK_INT *lwork, LAPACK_INT *info);
+void F77NAME(zgesvd)(char *jobu, char *jobvt, LAPACK_INT *m, LAPACK_INT *n, LAPACK_COMPLEX *a, LAPACK_INT *lda, double *s, 
+             LAPACK_COMPLEX *u, LAPACK_INT *ldu, LAPACK_COMPLEX *vt, LAPACK_INT *ldvt, 
+             LAPACK_COMPLEX *work, LAPACK_INT *lwork, double *rwork, LAPACK_INT *info);
+#endif
+
 void F77NAME(dgeqrf)(LAPACK_INT *m, LAPACK_INT *n, double *a, LAPACK_INT *lda, 
                      double *tau, double *work, LAPACK_INT *lwork, LAPACK_INT *info);
 
@@ -502,6 +527,47 @@ zgesdd_wrapper(char *jobz,           //char* specifying how much of U, V to comp
                LAPACK_COMPLEX *vt,   //on return, unitary matrix V transpose
                LAPACK_INT *info);
 
+//
+// gesdd (divide and conquer) and gesvd
+//
+// Thin SVD A = U*diag(s)*VT of the m x n column-major
+// matrix A, computing min(m,n) columns of U (m x min(m,n))
+// and rows of VT (min(m,n) x n). Singular values s are
+// returned in decreasing order. Contents of A are destroyed.
+// Returns info (0 on success).
+//
+LAPACK_INT
+gesdd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              LAPACK_REAL* A,
+              LAPACK_REAL* s,
+              LAPACK_REAL* u,
+              LAPACK_REAL* vt);
+
+LAPACK_INT
+gesdd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              Cplx* A,
+              LAPACK_REAL* s,
+              Cplx* u,
+              Cplx* vt);
+
+LAPACK_INT
+gesvd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              LAPACK_REAL* A,
+              LAPACK_REAL* s,
+              LAPACK_REAL* u,
+              LAPACK_REAL* vt);
+
+LAPACK_INT
+gesvd_wrapper(LAPACK_INT m,
+              LAPACK_INT n,
+              Cplx* A,
+              LAPACK_REAL* s,
+              Cplx* u,
+              Cplx* vt);
+
 //
 // dgeqrf
 //
@@ -329,6 +329,19 @@ operator<<(std::ostream& s, CMatrixRefc const& M)
 //    gemm(A,B,C,1.,0.);
 //    }
 
+template<typename VA, typename VB>
+void
+mult(MatRefc<VA> A, 
+     MatRefc<VB> B, 
+     MatRef<common_type<VA,VB>> C)
+    {
+    gemm(A,B,C,1.,0.);
+    }
+template void mult(MatRefc<Real>, MatRefc<Real>, MatRef<Real>);
+template void mult(MatRefc<Real>, MatRefc<Cplx>, MatRef<Cplx>);
+template void mult(MatRefc<Cplx>, MatRefc<Real>, MatRef<Cplx>);
+template void mult(MatRefc<Cplx>, MatRefc<Cplx>, MatRef<Cplx>);
+
 void
 multAdd(MatrixRefc A, 
         MatrixRefc B, 
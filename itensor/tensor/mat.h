@@ -111,6 +111,35 @@ gemm(MatRefc<VA> A,
      Real alpha,
      Real beta);
 
+//
+// Algorithm used by gemm when A and B are both complex:
+// o Native:  a single zgemm call
+// o ThreeM:  "3M" method, three dgemm calls on the split
+//            real and imaginary parts (25% fewer flops,
+//            slightly larger rounding errors)
+// o Emulate: four dgemm calls on the real and imaginary parts
+// o Auto:    ThreeM once m*n*k reaches getZGemm3MSize(),
+//            otherwise Native (or Emulate if the platform's
+//            zgemm is not used, i.e. ITENSOR_USE_ZGEMM is
+//            not defined)
+// The default is Auto; the 3M size can also be set with the
+// environment variable ITENSOR_ZGEMM_3M_SIZE
+// (see benchmark/zgemm_bench to measure it).
+//
+enum class ZGemmMethod { Auto, Native, ThreeM, Emulate };
+
+ZGemmMethod
+getZGemmMethod();
+
+void
+setZGemmMethod(ZGemmMethod method);
+
+long
+getZGemm3MSize();
+
+void
+setZGemm3MSize(long size);
+
 template<typename VA, typename VB>
 void
 mult(MatRefc<VA> A, 
@@ -0,0 +1,83 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <atomic>
+#include <cstdlib>
+#include "itensor/tensor/permutekernel.h"
+
+namespace itensor {
+
+static long
+defaultPermuteParallelSize()
+    {
+    auto env = std::getenv("ITENSOR_PERMUTE_PARALLEL_SIZE");
+    if(env) return std::atol(env);
+    return 1l << 16;
+    }
+
+static std::atomic<long>&
+permuteParallelSizeFlag()
+    {
+    static std::atomic<long> size{defaultPermuteParallelSize()};
+    return size;
+    }
+
+long
+getPermuteParallelSize() { return permuteParallelSizeFlag().load(); }
+
+void
+setPermuteParallelSize(long size) { permuteParallelSizeFlag() = size; }
+
+void
+simplifyStridedDims(StridedDims & dims)
+    {
+    //Drop indices of extent 1
+    size_t r = 0;
+    for(size_t j = 0; j < dims.size(); ++j)
+        {
+        if(dims[j].ext != 1) dims[r++] = dims[j];
+        }
+    dims.resize(r);
+    if(r == 0) return;
+    //Insertion sort by stride in to
+    //(r is small)
+    for(size_t j = 1; j < r; ++j)
+        {
+        auto d = dims[j];
+        auto k = j;
+        for(; k > 0 && dims[k-1].sto > d.sto; --k) dims[k] = dims[k-1];
+        dims[k] = d;
+        }
+    //Merge index j+1 into j when stepping over
+    //all of index j is one step of index j+1
+    //in both tensors
+    size_t m = 0;
+    for(size_t j = 1; j < r; ++j)
+        {
+        auto& D = dims[m];
+        auto const& N = dims[j];
+        if(N.sto == D.sto*D.ext && N.sfrom == D.sfrom*D.ext)
+            {
+            D.ext *= N.ext;
+            }
+        else
+            {
+            dims[++m] = N;
+            }
+        }
+    dims.resize(m+1);
+    }
+
+} //namespace itensor
@@ -0,0 +1,254 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_PERMUTEKERNEL_H
+#define __ITENSOR_PERMUTEKERNEL_H
+
+#include <vector>
+#include <algorithm>
+#include "itensor/util/infarray.h"
+#include "itensor/util/safe_ptr.h"
+#include "itensor/util/threadpool.h"
+
+namespace itensor {
+
+//
+// Element-wise kernel behind transform (and so behind
+// A &= permute(B,P), A += permute(B,P), ...):
+// applies op(from[i],to[i]) for every index value i
+// of two strided tensors with the same extents.
+//
+// o Indices of extent 1 are dropped and indices laid
+//   out contiguously in both tensors are merged, so
+//   e.g. a rank-4 permutation moving whole blocks
+//   becomes a 2D transpose.
+// o If the fastest-varying index of to differs from
+//   that of from, those two indices are walked in
+//   square tiles small enough to stay in L1 cache
+//   (a blocked transpose); full tiles of contiguous
+//   data use fixed-size loops the compiler can unroll
+//   and vectorize.
+// o Transforms of at least getPermuteParallelSize()
+//   elements are split over the threads of threadPool()
+//   along the slowest-varying index of to (or the
+//   longest index if that one is too short).
+//   The default size is 2^16, or the value of the
+//   environment variable ITENSOR_PERMUTE_PARALLEL_SIZE;
+//   a negative size always uses one thread.
+//
+
+long
+getPermuteParallelSize();
+
+void
+setPermuteParallelSize(long size);
+
+struct StridedDim
+    {
+    size_t ext = 0,
+           sfrom = 0,
+           sto = 0;
+    };
+
+using StridedDims = InfArray<StridedDim,16ul>;
+
+//Drop indices of extent 1, order the rest from
+//fastest to slowest varying in to and merge
+//neighbors which are contiguous in both tensors
+void
+simplifyStridedDims(StridedDims & dims);
+
+int inline
+permuteNThread(size_t size)
+    {
+    auto psize = getPermuteParallelSize();
+    if(psize < 0 || size < size_t(psize)) return 1;
+    return getNThread();
+    }
+
+namespace detail {
+
+template<typename T1, typename T2, typename Op>
+class StridedKernel
+    {
+    public:
+    //Tile edge: 32x32 doubles or 16x16 complex
+    //numbers take 8kB of each tensor
+    static constexpr size_t TS = (sizeof(T2) > 8 || sizeof(T1) > 8) ? 16 : 32;
+    //Bounds-checked pointers if DEBUG is defined
+    using PF = SAFE_PTR_OF(T1 const);
+    using PT = SAFE_PTR_OF(T2);
+    private:
+    StridedDims outer_;
+    StridedDim a_, //fastest index of to
+               b_; //fastest index of from (if tiled)
+    bool tiled_ = false;
+    Op & op_;
+    public:
+
+    StridedKernel(StridedDims const& dims,
+                  Op & op)
+      : op_(op)
+        {
+        //dims are ordered fastest first in to
+        size_t b = 0;
+        for(size_t j = 1; j < dims.size(); ++j)
+            if(dims[j].sfrom < dims[b].sfrom) b = j;
+        a_ = dims[0];
+        tiled_ = (b != 0);
+        if(tiled_) b_ = dims[b];
+        //Store the remaining indices slowest first
+        for(size_t j = dims.size(); j > 1; --j)
+            {
+            if(tiled_ && j-1 == b) continue;
+            outer_.push_back(dims[j-1]);
+            }
+        }
+
+    void
+    operator()(PF pf, PT pt) const { loop(pf,pt,0); }
+
+    private:
+
+    void
+    loop(PF pf, 
+         PT pt,
+         size_t level) const
+        {
+        if(level == outer_.size())
+            {
+            if(tiled_) tile(pf,pt);
+            else       line(pf,pt);
+            return;
+            }
+        auto const& D = outer_[level];
+        for(size_t i = 0; i < D.ext; ++i, pf += D.sfrom, pt += D.sto)
+            {
+            loop(pf,pt,level+1);
+            }
+        }
+
+    void
+    line(PF pf, 
+         PT pt) const
+        {
+        if(a_.sfrom == 1 && a_.sto == 1)
+            {
+            for(size_t i = 0; i < a_.ext; ++i) op_(pf[i],pt[i]);
+            return;
+            }
+        for(size_t i = 0; i < a_.ext; ++i, pf += a_.sfrom, pt += a_.sto)
+            {
+            op_(*pf,*pt);
+            }
+        }
+
+    void
+    tile(PF pf, 
+         PT pt) const
+        {
+        auto unit = (a_.sto == 1 && b_.sfrom == 1);
+        for(size_t jb = 0; jb < b_.ext; jb += TS)
+        for(size_t ib = 0; ib < a_.ext; ib += TS)
+            {
+            auto pfb = pf + ib*a_.sfrom + jb*b_.sfrom;
+            auto ptb = pt + ib*a_.sto + jb*b_.sto;
+            auto ni = std::min(TS,a_.ext-ib),
+                 nj = std::min(TS,b_.ext-jb);
+            if(unit && ni == TS && nj == TS)
+                {
+                fullTile(pfb,ptb);
+                continue;
+                }
+            for(size_t j = 0; j < nj; ++j)
+            for(size_t i = 0; i < ni; ++i)
+                {
+                op_(pfb[i*a_.sfrom+j*b_.sfrom],ptb[i*a_.sto+j*b_.sto]);
+                }
+            }
+        }
+
+    //Transpose of a full TS x TS tile
+    //with unit stride in from and to
+    void
+    fullTile(PF pf, 
+             PT pt) const
+        {
+        auto lf = a_.sfrom,
+             lt = b_.sto;
+        for(size_t j = 0; j < TS; ++j)
+            {
+            auto ptj = pt + j*lt;
+            auto pfj = pf + j;
+            for(size_t i = 0; i < TS; ++i)
+                {
+                op_(pfj[i*lf],ptj[i]);
+                }
+            }
+        }
+    };
+
+} //namespace detail
+
+//
+// Apply op(from_el,to_el) to the elements at pf and pt
+// described by dims (as returned by simplifyStridedDims),
+// using up to nthread threads of threadPool().
+// pf and pt are made with MAKE_SAFE_PTR, so they are
+// bounds checked if DEBUG is defined.
+//
+template<typename T1, typename T2, typename Op>
+void
+stridedTransform(SAFE_PTR_OF(T1 const) pf,
+                 SAFE_PTR_OF(T2) pt,
+                 StridedDims const& dims,
+                 Op & op,
+                 int nthread = 1)
+    {
+    if(dims.empty())
+        {
+        op(*pf,*pt);
+        return;
+        }
+    if(nthread <= 1)
+        {
+        detail::StridedKernel<T1,T2,Op>(dims,op)(pf,pt);
+        return;
+        }
+    //Split the slowest index of to, or the
+    //longest index if there are too few values
+    auto s = dims.size()-1;
+    if(dims[s].ext < size_t(nthread))
+        {
+        for(size_t j = 0; j < dims.size(); ++j)
+            if(dims[j].ext > dims[s].ext) s = j;
+        }
+    auto ext = dims[s].ext;
+    auto nchunk = std::min(size_t(nthread),ext);
+    auto costs = std::vector<double>(nchunk,1.);
+    parallelFor(threadPool(),costs,int(nchunk),[&](size_t c)
+        {
+        auto start = (ext*c)/nchunk,
+             stop = (ext*(c+1))/nchunk;
+        auto cdims = dims;
+        cdims[s].ext = stop-start;
+        detail::StridedKernel<T1,T2,Op>(cdims,op)(pf+start*dims[s].sfrom,
+                                                  pt+start*dims[s].sto);
+        });
+    }
+
+} //namespace itensor
+
+#endif
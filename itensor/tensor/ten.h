@@ -20,6 +20,7 @@
 #include "itensor/tensor/teniter.h"
 #include "itensor/tensor/range.h"
 #include "itensor/tensor/lapack_wrap.h"
+#include "itensor/tensor/permutekernel.h"
 
 namespace itensor {
 
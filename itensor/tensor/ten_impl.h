@@ -115,48 +115,22 @@ transform(TenRefc<R1,T1> const& from,
 #ifdef DEBUG
     checkCompatible(to,from,"transform");
 #endif 
-    using size_type = decltype(from.extent(0));
     auto r = to.order();
-    if(r == 0)
+    auto dims = StridedDims(r);
+    size_t size = 1;
+    for(decltype(r) j = 0; j < r; ++j)
         {
-        op(*(from.data()),*(to.data()));
-        return;
-        }
-
-    //find size and location of largest index of from
-    size_type bigind = 0, 
-              bigsize = from.extent(0);
-    for(decltype(r) j = 1; j < r; ++j)
-        if(bigsize < from.extent(j))
-            {
-            bigsize = from.extent(j); 
-            bigind = j;
-            }
-
-    auto stepfrom = from.stride(bigind);
-    auto stepto = to.stride(bigind);
-
-    auto RB = RangeBuilder(r);
-    for(decltype(r) i = 0; i < r; ++i)
-        RB.setIndex(i,from.extent(i));
-    //Leave bigind fixed to zero, will
-    //increment manually in the loop below
-    RB.setIndex(bigind,1);
-
-    for(auto& i : RB.build())
-        {
-        //println("i = ",i);
-        //printfln("to (offset,size) = (%d,%d)",offset(to,i),to.store().size());
-        //printfln("from (offset,size) = (%d,%d)",offset(from,i),from.store().size());
-        auto pto = MAKE_SAFE_PTR_OFFSET(to.data(),offset(to,i),to.store().size());
-        auto pfrom = MAKE_SAFE_PTR_OFFSET(from.data(),offset(from,i),from.store().size());
-        for(decltype(bigsize) b = 0; b < bigsize; ++b)
-            {
-            op(*pfrom,*pto);
-            pto += stepto;
-            pfrom += stepfrom;
-            }
+        auto& D = dims[j];
+        D.ext = from.extent(j);
+        D.sfrom = from.stride(j);
+        D.sto = to.stride(j);
+        size *= D.ext;
         }
+    if(size == 0) return;
+    simplifyStridedDims(dims);
+    auto pfrom = MAKE_SAFE_PTR(from.data(),from.store().size());
+    auto pto = MAKE_SAFE_PTR(to.data(),to.store().size());
+    stridedTransform(pfrom,pto,dims,op,permuteNThread(size));
     }
 
 //Assign to referenced data
@@ -0,0 +1,317 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <sstream>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "itensor/tensorfile.h"
+#include "itensor/itdata/applyfunc.h"
+
+namespace itensor {
+
+const char TENSORFILE_MAGIC[8] = {'I','T','E','N','S','O','R','M'};
+const int64_t TENSORFILE_VERSION = 1;
+//Raw data starts at a multiple of this
+//(the page size of most systems)
+const int64_t TENSORFILE_ALIGN = 4096;
+
+struct TensorFileHeader
+    {
+    char magic[8];
+    int64_t version = TENSORFILE_VERSION;
+    int64_t type = 0;
+    int64_t raw = 0;          //1 if the data is stored raw
+    int64_t meta_size = 0;
+    int64_t data_offset = 0;
+    int64_t data_size = 0;    //in bytes
+    };
+
+struct RawStorage
+    {
+    void const* data = nullptr;
+    size_t bytes = 0;
+    std::vector<BlOf> const* offsets = nullptr;
+
+    template<typename V>
+    void
+    operator()(Dense<V> const& d)
+        {
+        data = d.data();
+        bytes = d.size()*sizeof(V);
+        }
+
+    template<typename V>
+    void
+    operator()(QDense<V> const& d)
+        {
+        data = d.data();
+        bytes = d.size()*sizeof(V);
+        offsets = &d.offsets;
+        }
+
+    template<typename D>
+    void
+    operator()(D const& d) { }
+    };
+
+void
+writeToMappedFile(std::string const& fname, ITensor const& T)
+    {
+    auto h = TensorFileHeader{};
+    std::memcpy(h.magic,TENSORFILE_MAGIC,sizeof(h.magic));
+
+    auto raw = RawStorage{};
+    if(T.store())
+        {
+        h.type = doTask(StorageType{},T.store());
+        applyFunc(raw,T.store());
+        }
+    h.raw = (raw.data != nullptr) ? 1 : 0;
+
+    std::ostringstream meta;
+    if(h.raw)
+        {
+        itensor::write(meta,T.inds());
+        itensor::write(meta,T.scale());
+        if(raw.offsets) itensor::write(meta,*raw.offsets);
+        }
+    else
+        {
+        T.write(meta);
+        }
+    auto metastr = meta.str();
+    h.meta_size = metastr.size();
+    if(h.raw)
+        {
+        auto end = int64_t(sizeof(h))+h.meta_size;
+        h.data_offset = ((end+TENSORFILE_ALIGN-1)/TENSORFILE_ALIGN)*TENSORFILE_ALIGN;
+        h.data_size = raw.bytes;
+        }
+
+    auto tmpname = fname + ".tmp";
+        {
+        std::ofstream s(tmpname.c_str(),std::ios::binary);
+        if(!s.good()) throw ITError("Couldn't open file \"" + tmpname + "\" for writing");
+        s.write(reinterpret_cast<char const*>(&h),sizeof(h));
+        s.write(metastr.data(),metastr.size());
+        if(h.raw)
+            {
+            auto pad = std::string(h.data_offset-sizeof(h)-h.meta_size,'\0');
+            s.write(pad.data(),pad.size());
+            s.write(reinterpret_cast<char const*>(raw.data),raw.bytes);
+            }
+        if(!s.good()) throw ITError("Error writing file \"" + tmpname + "\"");
+        }
+    if(std::rename(tmpname.c_str(),fname.c_str()) != 0)
+        {
+        throw ITError("Couldn't rename \"" + tmpname + "\" to \"" + fname + "\"");
+        }
+    }
+
+bool
+isMappedFile(std::string const& fname)
+    {
+    std::ifstream s(fname.c_str(),std::ios::binary);
+    char magic[8] = {};
+    s.read(magic,sizeof(magic));
+    return s.good() && std::memcmp(magic,TENSORFILE_MAGIC,sizeof(magic)) == 0;
+    }
+
+void
+readFromMappedFile(std::string const& fname, ITensor & T)
+    {
+    if(!isMappedFile(fname))
+        {
+        readFromFile(fname,T);
+        return;
+        }
+    T = MappedTensorFile(fname).toITensor();
+    }
+
+ITensor
+readFromMappedFile(std::string const& fname)
+    {
+    auto T = ITensor{};
+    readFromMappedFile(fname,T);
+    return T;
+    }
+
+MappedTensorFile::
+MappedTensorFile(std::string const& fname)
+    {
+    auto fd = ::open(fname.c_str(),O_RDONLY);
+    if(fd < 0) throw ITError("Couldn't open file \"" + fname + "\" for reading");
+    struct stat st;
+    if(::fstat(fd,&st) != 0 || size_t(st.st_size) < sizeof(TensorFileHeader))
+        {
+        ::close(fd);
+        throw ITError("File \"" + fname + "\" is not a mapped tensor file");
+        }
+    map_size_ = st.st_size;
+    auto p = ::mmap(nullptr,map_size_,PROT_READ,MAP_PRIVATE,fd,0);
+    ::close(fd);
+    if(p == MAP_FAILED) throw ITError("Couldn't map file \"" + fname + "\"");
+    map_ = p;
+
+    auto base = static_cast<char const*>(map_);
+    auto h = TensorFileHeader{};
+    std::memcpy(&h,base,sizeof(h));
+    if(std::memcmp(h.magic,TENSORFILE_MAGIC,sizeof(h.magic)) != 0
+       || h.version != TENSORFILE_VERSION
+       || size_t(sizeof(h)+h.meta_size) > map_size_
+       || size_t(h.data_offset+h.data_size) > map_size_)
+        {
+        unmap();
+        throw ITError("File \"" + fname + "\" is not a mapped tensor file");
+        }
+    type_ = StorageType::Type(h.type);
+    meta_ = std::string(base+sizeof(h),h.meta_size);
+
+    if(h.raw)
+        {
+        std::istringstream meta(meta_);
+        itensor::read(meta,is_);
+        itensor::read(meta,scale_);
+        if(type_ == StorageType::QDenseReal || type_ == StorageType::QDenseCplx)
+            {
+            itensor::read(meta,offsets_);
+            }
+        meta_.clear();
+        data_offset_ = h.data_offset;
+        data_size_ = h.data_size;
+        //The data is usually read once, front to back
+        ::madvise(const_cast<char*>(base),map_size_,MADV_SEQUENTIAL);
+        }
+    else
+        {
+        std::istringstream meta(meta_);
+        auto T = ITensor{};
+        T.read(meta);
+        is_ = T.inds();
+        scale_ = T.scale();
+        }
+    }
+
+MappedTensorFile::
+MappedTensorFile(MappedTensorFile && other)
+    {
+    *this = std::move(other);
+    }
+
+MappedTensorFile& MappedTensorFile::
+operator=(MappedTensorFile && other)
+    {
+    unmap();
+    is_ = std::move(other.is_);
+    scale_ = other.scale_;
+    type_ = other.type_;
+    offsets_ = std::move(other.offsets_);
+    meta_ = std::move(other.meta_);
+    map_ = other.map_;
+    map_size_ = other.map_size_;
+    data_offset_ = other.data_offset_;
+    data_size_ = other.data_size_;
+    other.map_ = nullptr;
+    other.map_size_ = 0;
+    return *this;
+    }
+
+MappedTensorFile::
+~MappedTensorFile()
+    {
+    unmap();
+    }
+
+void MappedTensorFile::
+unmap()
+    {
+    if(map_) ::munmap(map_,map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+    }
+
+size_t MappedTensorFile::
+size() const
+    {
+    if(type_ == StorageType::DenseCplx || type_ == StorageType::QDenseCplx)
+        {
+        return data_size_/sizeof(Cplx);
+        }
+    return data_size_/sizeof(Real);
+    }
+
+Real const* MappedTensorFile::
+realData() const
+    {
+    if(type_ != StorageType::DenseReal && type_ != StorageType::QDenseReal)
+        {
+        throw ITError("MappedTensorFile::realData: storage is not DenseReal or QDenseReal");
+        }
+    return reinterpret_cast<Real const*>(static_cast<char const*>(map_)+data_offset_);
+    }
+
+Cplx const* MappedTensorFile::
+cplxData() const
+    {
+    if(type_ != StorageType::DenseCplx && type_ != StorageType::QDenseCplx)
+        {
+        throw ITError("MappedTensorFile::cplxData: storage is not DenseCplx or QDenseCplx");
+        }
+    return reinterpret_cast<Cplx const*>(static_cast<char const*>(map_)+data_offset_);
+    }
+
+ITensor MappedTensorFile::
+toITensor() const
+    {
+    if(!map_) return ITensor{};
+    if(!meta_.empty())
+        {
+        std::istringstream meta(meta_);
+        auto T = ITensor{};
+        T.read(meta);
+        return T;
+        }
+    auto n = size();
+    if(type_ == StorageType::DenseReal)
+        {
+        auto p = realData();
+        return ITensor(is_,DenseReal(p,p+n),scale_);
+        }
+    if(type_ == StorageType::DenseCplx)
+        {
+        auto p = cplxData();
+        return ITensor(is_,DenseCplx(p,p+n),scale_);
+        }
+    if(type_ == StorageType::QDenseReal)
+        {
+        auto p = realData();
+        return ITensor(is_,QDenseReal(offsets_,p,p+n),scale_);
+        }
+    if(type_ == StorageType::QDenseCplx)
+        {
+        auto p = cplxData();
+        return ITensor(is_,QDenseCplx(offsets_,p,p+n),scale_);
+        }
+    throw ITError("MappedTensorFile: unrecognized storage type");
+    return ITensor{};
+    }
+
+} //namespace itensor
@@ -0,0 +1,135 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_TENSORFILE_H
+#define __ITENSOR_TENSORFILE_H
+
+#include <string>
+#include "itensor/itensor.h"
+
+namespace itensor {
+
+//
+// Binary ITensor file format which can be memory-mapped:
+//
+//   header | metadata (indices, scale, block table) | padding
+//   | raw tensor data (starting at a page boundary)
+//
+// For Dense and QDense storage the tensor data is
+// stored as-is, so it can be used straight from the
+// mapped file; other storage types are kept in the
+// metadata in the format of itensor::write.
+//
+// writeToMappedFile writes to a temporary file and renames
+// it over fname, so existing hard links to fname keep
+// the old contents (which makes hard-linked copies of
+// directories of tensor files safe).
+//
+void
+writeToMappedFile(std::string const& fname, ITensor const& T);
+
+//
+// Reads a file written by writeToMappedFile.
+// Files not in the mapped format are read with
+// readFromFile, as written by writeToFile.
+//
+void
+readFromMappedFile(std::string const& fname, ITensor & T);
+
+ITensor
+readFromMappedFile(std::string const& fname);
+
+bool
+isMappedFile(std::string const& fname);
+
+//
+// Read-only view of a file written by writeToMappedFile.
+// The indices and scale are read when the file is
+// opened; realData() or cplxData() point directly into
+// the mapping (which stays valid for the lifetime of the
+// MappedTensorFile) so the data is only paged in as it
+// is used. toITensor() makes an ITensor holding a copy
+// of the data.
+//
+class MappedTensorFile
+    {
+    IndexSet is_;
+    LogNum scale_;
+    StorageType::Type type_ = StorageType::Null;
+    std::vector<BlOf> offsets_;
+    std::string meta_;
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+    size_t data_offset_ = 0;
+    size_t data_size_ = 0;
+    public:
+
+    MappedTensorFile() { }
+
+    explicit
+    MappedTensorFile(std::string const& fname);
+
+    MappedTensorFile(MappedTensorFile const&) = delete;
+
+    MappedTensorFile&
+    operator=(MappedTensorFile const&) = delete;
+
+    MappedTensorFile(MappedTensorFile && other);
+
+    MappedTensorFile&
+    operator=(MappedTensorFile && other);
+
+    ~MappedTensorFile();
+
+    explicit operator bool() const { return map_ != nullptr; }
+
+    IndexSet const&
+    inds() const { return is_; }
+
+    LogNum const&
+    scale() const { return scale_; }
+
+    StorageType::Type
+    type() const { return type_; }
+
+    //Block table of QDense storage
+    std::vector<BlOf> const&
+    offsets() const { return offsets_; }
+
+    //Number of elements of Dense or QDense storage
+    //(0 for other storage types)
+    size_t
+    size() const;
+
+    //Data of DenseReal or QDenseReal storage
+    Real const*
+    realData() const;
+
+    //Data of DenseCplx or QDenseCplx storage
+    Cplx const*
+    cplxData() const;
+
+    ITensor
+    toITensor() const;
+
+    private:
+
+    void
+    unmap();
+    };
+
+} //namespace itensor
+
+#endif
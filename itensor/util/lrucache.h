@@ -0,0 +1,150 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_LRUCACHE_H
+#define __ITENSOR_LRUCACHE_H
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <atomic>
+#include <functional>
+#include "itensor/util/infarray.h"
+
+namespace itensor {
+
+//
+// LRUCache - map holding at most capacity() entries,
+// discarding the least recently used entry when full
+//
+// o find(key) returns a pointer to the cached value
+//   (marking it as most recently used) or nullptr
+// o insert(key,val) adds or replaces an entry
+// o Not thread safe: use one cache per thread
+//   or protect it with a mutex
+//
+
+template<typename Key,
+         typename Value,
+         typename Hash = std::hash<Key>>
+class LRUCache
+    {
+    using list_type = std::list<std::pair<Key,Value>>;
+    list_type items_;
+    std::unordered_map<Key,typename list_type::iterator,Hash> index_;
+    size_t capacity_ = 0;
+    public:
+
+    explicit
+    LRUCache(size_t capacity) : capacity_(capacity) { }
+
+    size_t
+    size() const { return items_.size(); }
+
+    size_t
+    capacity() const { return capacity_; }
+
+    void
+    clear()
+        {
+        index_.clear();
+        items_.clear();
+        }
+
+    Value*
+    find(Key const& key)
+        {
+        auto it = index_.find(key);
+        if(it == index_.end()) return nullptr;
+        items_.splice(items_.begin(),items_,it->second);
+        return &(it->second->second);
+        }
+
+    Value&
+    insert(Key const& key, Value val)
+        {
+        auto it = index_.find(key);
+        if(it != index_.end())
+            {
+            it->second->second = std::move(val);
+            items_.splice(items_.begin(),items_,it->second);
+            return it->second->second;
+            }
+        if(capacity_ > 0 && items_.size() >= capacity_)
+            {
+            index_.erase(items_.back().first);
+            items_.pop_back();
+            }
+        items_.emplace_front(key,std::move(val));
+        index_.emplace(key,items_.begin());
+        return items_.front().second;
+        }
+    };
+
+//
+// Hit/miss counters for caches, safe to
+// update from several threads at once
+//
+struct CacheCounters
+    {
+    std::atomic<long> hits{0},
+                      misses{0};
+    };
+
+struct CacheStats
+    {
+    long hits = 0,
+         misses = 0;
+
+    CacheStats() { }
+
+    CacheStats(CacheCounters const& c)
+      : hits(c.hits.load()),
+        misses(c.misses.load())
+        { }
+
+    double
+    hitRate() const { return (hits+misses) == 0 ? 0. : double(hits)/double(hits+misses); }
+    };
+
+//
+// Key made of a list of integers,
+// e.g. labels and extents of a tensor contraction
+//
+using PlanKey = InfArray<long,40ul>;
+
+struct PlanKeyHash
+    {
+    size_t
+    operator()(PlanKey const& k) const
+        {
+        size_t h = k.size();
+        for(auto el : k) h ^= std::hash<long>{}(el) + 0x9e3779b97f4a7c15ul + (h << 6) + (h >> 2);
+        return h;
+        }
+    };
+
+bool inline
+operator==(PlanKey const& k1, PlanKey const& k2)
+    {
+    if(k1.size() != k2.size()) return false;
+    for(decltype(k1.size()) n = 0; n < k1.size(); ++n)
+        if(k1[n] != k2[n]) return false;
+    return true;
+    }
+
+} //namespace itensor
+
+#endif
@@ -16,6 +16,7 @@
 #ifndef __ITENSOR_READWRITE_H_
 #define __ITENSOR_READWRITE_H_
 
+#include <filesystem>
 #include <fstream>
 #include <memory>
 #include <vector>
@@ -372,6 +373,19 @@ mkTempDir(const std::string& pfix,
     return final_dirname;
     }
 
+//Removes a directory made by mkTempDir
+//together with everything written into it
+//Does not throw (so it is safe to call from
+//destructors); returns false if removal failed
+bool inline
+rmTempDir(const std::string& dirname)
+    {
+    if(dirname.empty()) return true;
+    std::error_code ec;
+    std::filesystem::remove_all(dirname,ec);
+    return !ec;
+    }
+
 } // namespace itensor
 
 #endif
@@ -0,0 +1,166 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include "itensor/util/scratch.h"
+
+namespace itensor {
+
+struct ScratchCounters
+    {
+    std::atomic<long> requests{0},
+                      allocations{0},
+                      in_use{0},
+                      peak{0},
+                      cached{0};
+    };
+
+static ScratchCounters&
+scratchCounters()
+    {
+    static ScratchCounters counters;
+    return counters;
+    }
+
+//Class c holds 2^(MinClass+o)*(1+q/4) bytes
+//with o = c/4 and q = c%4
+static size_t
+classBytes(int cls)
+    {
+    auto o = cls/ScratchArena::ClassesPerOctave,
+         q = cls%ScratchArena::ClassesPerOctave;
+    auto base = size_t(1) << (o+ScratchArena::MinClass);
+    return base + q*(base/ScratchArena::ClassesPerOctave);
+    }
+
+static int
+sizeClass(size_t nbytes)
+    {
+    if(nbytes > ScratchArena::LargeBytes) return -1;
+    int cls = 0;
+    while(classBytes(cls) < nbytes) ++cls;
+    return cls;
+    }
+
+static size_t
+blockBytes(size_t nbytes, int cls) { return cls < 0 ? nbytes : classBytes(cls); }
+
+ScratchArena::
+~ScratchArena()
+    {
+    clear();
+    }
+
+void* ScratchArena::
+acquire(size_t nbytes, int & cls)
+    {
+    auto& C = scratchCounters();
+    cls = sizeClass(nbytes);
+    auto bytes = long(blockBytes(nbytes,cls));
+    ++C.requests;
+    void* p = nullptr;
+    if(cls >= 0 && !free_[cls].empty())
+        {
+        auto& F = free_[cls];
+        p = F.back();
+        F.pop_back();
+        cached_ -= bytes;
+        C.cached -= bytes;
+        }
+    else
+        {
+        p = std::malloc(bytes);
+        if(!p) throw std::bad_alloc();
+        ++C.allocations;
+        }
+    auto now = (C.in_use += bytes);
+    auto peak = C.peak.load();
+    while(now > peak && !C.peak.compare_exchange_weak(peak,now)) { }
+    return p;
+    }
+
+void ScratchArena::
+release(void* p, size_t nbytes, int cls)
+    {
+    auto& C = scratchCounters();
+    auto bytes = blockBytes(nbytes,cls);
+    C.in_use -= long(bytes);
+    if(cls >= 0
+       && free_[cls].size() < MaxCached
+       && cached_+bytes <= MaxCachedBytes)
+        {
+        free_[cls].push_back(p);
+        cached_ += bytes;
+        C.cached += long(bytes);
+        }
+    else
+        {
+        std::free(p);
+        }
+    }
+
+void ScratchArena::
+clear()
+    {
+    auto& C = scratchCounters();
+    for(auto cls = 0; cls < NClass; ++cls)
+        {
+        auto& F = free_[cls];
+        for(auto p : F) std::free(p);
+        C.cached -= long(F.size()*classBytes(cls));
+        F.clear();
+        }
+    cached_ = 0;
+    }
+
+ScratchArena&
+scratchArena()
+    {
+    thread_local ScratchArena arena;
+    return arena;
+    }
+
+void
+clearScratch()
+    {
+    scratchArena().clear();
+    }
+
+ScratchStats
+scratchStats()
+    {
+    auto& C = scratchCounters();
+    auto s = ScratchStats{};
+    s.requests = C.requests.load();
+    s.allocations = C.allocations.load();
+    s.bytes_in_use = size_t(C.in_use.load());
+    s.peak_bytes = size_t(C.peak.load());
+    s.bytes_cached = size_t(C.cached.load());
+    return s;
+    }
+
+void
+resetScratchStats()
+    {
+    auto& C = scratchCounters();
+    C.requests = 0;
+    C.allocations = 0;
+    C.peak = C.in_use.load();
+    }
+
+} //namespace itensor
@@ -0,0 +1,204 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_SCRATCH_H
+#define __ITENSOR_SCRATCH_H
+
+#include <cstddef>
+#include <array>
+#include <vector>
+#include <algorithm>
+
+namespace itensor {
+
+//
+// ScratchArena - per-thread cache of memory blocks
+// for short-lived temporaries (permuted copies in
+// contract, real/imaginary buffers in gemm, matrices
+// used inside the SVD, ...)
+//
+// o Blocks are grouped in size classes (four per
+//   power of two, so a block is at most 25% larger
+//   than requested); a request is served by a cached
+//   block of its class if there is one, otherwise
+//   by malloc
+// o Requests larger than LargeBytes bypass the cache:
+//   they are malloc'd at their exact size and freed
+//   on release
+// o Blocks return to the cache of the releasing thread,
+//   which holds at most MaxCachedBytes (blocks beyond
+//   that are freed); the cache is only handed back to
+//   the system by clearScratch() or when the thread exits
+// o Use through ScratchBuffer below, which gives
+//   its block back when it goes out of scope
+//
+class ScratchArena
+    {
+    public:
+    //Smallest class holds 2^MinClass bytes
+    static constexpr int MinClass = 8;
+    static constexpr int ClassesPerOctave = 4;
+    //Largest cached block: 2^LargeClass bytes (64MB)
+    static constexpr int LargeClass = 26;
+    static constexpr size_t LargeBytes = size_t(1) << LargeClass;
+    static constexpr int NClass = ClassesPerOctave*(LargeClass-MinClass)+1;
+    //At most this many cached blocks per class
+    static constexpr size_t MaxCached = 8;
+    //and at most this many cached bytes per thread
+    static constexpr size_t MaxCachedBytes = size_t(1) << 28;
+    private:
+    std::array<std::vector<void*>,NClass> free_;
+    size_t cached_ = 0;
+    public:
+
+    ScratchArena() { }
+
+    ~ScratchArena();
+
+    ScratchArena(ScratchArena const&) = delete;
+
+    ScratchArena& operator=(ScratchArena const&) = delete;
+
+    //Returns a block of at least nbytes and sets cls
+    //to its size class (-1 for a block of more than
+    //LargeBytes, which is not cached)
+    void*
+    acquire(size_t nbytes, int & cls);
+
+    //nbytes and cls as passed to and set by acquire
+    void
+    release(void* p, size_t nbytes, int cls);
+
+    //Bytes in this thread's cache
+    size_t
+    cachedBytes() const { return cached_; }
+
+    //Free all cached blocks
+    void
+    clear();
+    };
+
+//Arena of the calling thread
+ScratchArena&
+scratchArena();
+
+//Free blocks cached by the calling thread
+void
+clearScratch();
+
+//
+// Totals over all threads:
+// o requests: number of buffers handed out
+// o allocations: number of those which needed a malloc
+// o bytes_in_use: bytes held by live ScratchBuffers
+//   (rounded up to their size class if cached)
+// o peak_bytes: maximum of bytes_in_use
+// o bytes_cached: bytes held in the arenas' caches
+//
+struct ScratchStats
+    {
+    long requests = 0,
+         allocations = 0;
+    size_t bytes_in_use = 0,
+           peak_bytes = 0,
+           bytes_cached = 0;
+    };
+
+ScratchStats
+scratchStats();
+
+//Zero the counters and set peak_bytes to bytes_in_use
+void
+resetScratchStats();
+
+//
+// ScratchBuffer<T> - uninitialized array of n elements
+// of a trivially copyable type T (Real, Cplx, ...) drawn
+// from the scratch arena and returned at scope exit
+//
+template<typename T>
+class ScratchBuffer
+    {
+    T* p_ = nullptr;
+    size_t size_ = 0;
+    int cls_ = -1;
+    public:
+    using value_type = T;
+
+    ScratchBuffer() { }
+
+    explicit
+    ScratchBuffer(size_t size, bool zero = false)
+      : size_(size)
+        {
+        if(size_ == 0) return;
+        p_ = static_cast<T*>(scratchArena().acquire(size_*sizeof(T),cls_));
+        if(zero) std::fill(p_,p_+size_,T(0));
+        }
+
+    ~ScratchBuffer() { reset(); }
+
+    ScratchBuffer(ScratchBuffer const&) = delete;
+
+    ScratchBuffer& operator=(ScratchBuffer const&) = delete;
+
+    ScratchBuffer(ScratchBuffer && o)
+      : p_(o.p_), size_(o.size_), cls_(o.cls_)
+        {
+        o.p_ = nullptr;
+        o.size_ = 0;
+        o.cls_ = -1;
+        }
+
+    ScratchBuffer&
+    operator=(ScratchBuffer && o)
+        {
+        if(this == &o) return *this;
+        reset();
+        std::swap(p_,o.p_);
+        std::swap(size_,o.size_);
+        std::swap(cls_,o.cls_);
+        return *this;
+        }
+
+    size_t
+    size() const { return size_; }
+
+    T*
+    data() { return p_; }
+
+    T const*
+    data() const { return p_; }
+
+    T&
+    operator[](size_t n) { return p_[n]; }
+
+    T const&
+    operator[](size_t n) const { return p_[n]; }
+
+    //Give the memory back to the arena
+    void
+    reset()
+        {
+        if(p_) scratchArena().release(p_,size_*sizeof(T),cls_);
+        p_ = nullptr;
+        size_ = 0;
+        cls_ = -1;
+        }
+    };
+
+} //namespace itensor
+
+#endif
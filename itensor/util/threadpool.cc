@@ -0,0 +1,251 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <cstdlib>
+#include <exception>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include "itensor/util/threadpool.h"
+#include "itensor/util/args.h"
+
+namespace itensor {
+
+struct ThreadPool::Batch
+    {
+    std::atomic<long> remaining{0};
+    std::mutex m;
+    std::condition_variable cv;
+    std::exception_ptr err;
+    };
+
+ThreadPool::
+ThreadPool(int nthread)
+    : nthread_(nthread < 1 ? 1 : nthread)
+    {
+    if(nthread_ <= 1) return;
+    for(int q = 0; q < nthread_; ++q)
+        {
+        queues_.emplace_back(new Queue);
+        }
+    //Queue nthread_-1 has no owner: it holds
+    //the share of the calling thread and is
+    //drained by stealing
+    for(int q = 0; q < nthread_-1; ++q)
+        {
+        workers_.emplace_back([this,q]() { workerLoop(q); });
+        }
+    }
+
+ThreadPool::
+~ThreadPool()
+    {
+        {
+        std::lock_guard<std::mutex> lk(sleep_m_);
+        stop_ = true;
+        }
+    sleep_cv_.notify_all();
+    for(auto& w : workers_) w.join();
+    }
+
+bool ThreadPool::
+tryPop(int q, Item & it)
+    {
+    auto& Q = *queues_[q];
+    std::lock_guard<std::mutex> lk(Q.m);
+    if(Q.items.empty()) return false;
+    it = Q.items.front();
+    Q.items.pop_front();
+    --pending_;
+    return true;
+    }
+
+bool ThreadPool::
+trySteal(int q, Item & it)
+    {
+    auto nq = int(queues_.size());
+    for(int n = 1; n <= nq; ++n)
+        {
+        auto& Q = *queues_[(q+n)%nq];
+        std::lock_guard<std::mutex> lk(Q.m);
+        if(Q.items.empty()) continue;
+        //Steal from the back, away from
+        //where the owner pops
+        it = Q.items.back();
+        Q.items.pop_back();
+        --pending_;
+        return true;
+        }
+    return false;
+    }
+
+void ThreadPool::
+execute(Item const& it)
+    {
+    auto& b = *it.batch;
+    try
+        {
+        (*it.task)();
+        }
+    catch(...)
+        {
+        std::lock_guard<std::mutex> lk(b.m);
+        if(!b.err) b.err = std::current_exception();
+        }
+    //Decrement under the lock so that the
+    //waiting thread cannot destroy b while
+    //we are still using it
+    std::lock_guard<std::mutex> lk(b.m);
+    if(--b.remaining == 0) b.cv.notify_all();
+    }
+
+void ThreadPool::
+workerLoop(int q)
+    {
+    while(true)
+        {
+        Item it;
+        if(tryPop(q,it) || trySteal(q,it))
+            {
+            execute(it);
+            continue;
+            }
+        std::unique_lock<std::mutex> lk(sleep_m_);
+        sleep_cv_.wait(lk,[this]{ return stop_ || pending_.load() > 0; });
+        if(stop_ && pending_.load() == 0) return;
+        }
+    }
+
+void ThreadPool::
+run(std::vector<Task> & tasks)
+    {
+    if(nthread_ <= 1 || tasks.size() <= 1)
+        {
+        for(auto& t : tasks) t();
+        return;
+        }
+    auto nq = long(queues_.size());
+    auto order = std::vector<size_t>(tasks.size());
+    std::iota(order.begin(),order.end(),0);
+    auto queue_of = std::vector<int>(tasks.size());
+    auto q = next_queue_++;
+    for(auto& qo : queue_of) qo = int((q++)%nq);
+    runOn(tasks,order,queue_of);
+    }
+
+void ThreadPool::
+run(std::vector<Task> & tasks,
+    std::vector<double> const& costs)
+    {
+    if(costs.size() != tasks.size()) throw std::runtime_error("ThreadPool::run: wrong number of costs");
+    if(nthread_ <= 1 || tasks.size() <= 1)
+        {
+        for(auto& t : tasks) t();
+        return;
+        }
+    //Longest-processing-time-first assignment:
+    //hand out tasks in order of decreasing cost,
+    //each to the queue with the least total cost
+    //(so every queue also starts with its largest task)
+    auto order = std::vector<size_t>(tasks.size());
+    std::iota(order.begin(),order.end(),0);
+    std::stable_sort(order.begin(),order.end(),
+                     [&costs](size_t i, size_t j) { return costs[i] > costs[j]; });
+    auto load = std::vector<double>(queues_.size(),0.);
+    auto queue_of = std::vector<int>(tasks.size());
+    for(auto i : order)
+        {
+        auto q = std::min_element(load.begin(),load.end())-load.begin();
+        load[q] += costs[i];
+        queue_of[i] = int(q);
+        }
+    runOn(tasks,order,queue_of);
+    }
+
+void ThreadPool::
+runOn(std::vector<Task> & tasks,
+      std::vector<size_t> const& order,
+      std::vector<int> const& queue_of)
+    {
+    Batch b;
+    b.remaining = long(tasks.size());
+
+    for(auto i : order)
+        {
+        auto& Q = *queues_[queue_of[i]];
+        std::lock_guard<std::mutex> lk(Q.m);
+        Q.items.push_back(Item{&tasks[i],&b});
+        }
+        {
+        std::lock_guard<std::mutex> lk(sleep_m_);
+        pending_ += long(tasks.size());
+        }
+    sleep_cv_.notify_all();
+
+    //Help out until no queued work remains,
+    //then wait for tasks still in progress
+    auto nq = int(queues_.size());
+    Item it;
+    while(b.remaining.load() > 0 && trySteal(nq-1,it))
+        {
+        execute(it);
+        }
+    std::unique_lock<std::mutex> lk(b.m);
+    b.cv.wait(lk,[&b]{ return b.remaining.load() == 0; });
+    if(b.err) std::rethrow_exception(b.err);
+    }
+
+static std::mutex&
+poolMutex()
+    {
+    static std::mutex m;
+    return m;
+    }
+
+static std::unique_ptr<ThreadPool>&
+poolPtr()
+    {
+    static std::unique_ptr<ThreadPool> p;
+    return p;
+    }
+
+static int
+defaultNThread()
+    {
+    if(Args::global().defined("NThread")) return Args::global().getInt("NThread");
+    auto env = std::getenv("ITENSOR_NTHREAD");
+    if(env) return std::atoi(env);
+    return 1;
+    }
+
+ThreadPool&
+threadPool()
+    {
+    std::lock_guard<std::mutex> lk(poolMutex());
+    auto& p = poolPtr();
+    if(!p) p.reset(new ThreadPool(defaultNThread()));
+    return *p;
+    }
+
+void
+setNThread(int nthread)
+    {
+    std::lock_guard<std::mutex> lk(poolMutex());
+    auto& p = poolPtr();
+    if(p && p->nthread() == nthread) return;
+    p.reset(new ThreadPool(nthread));
+    }
+
+} //namespace itensor
@@ -0,0 +1,199 @@
+//
+// Copyright 2018 The Simons Foundation, Inc. - All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __ITENSOR_THREADPOOL_H
+#define __ITENSOR_THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <algorithm>
+
+namespace itensor {
+
+//
+// ThreadPool - fixed set of worker threads
+// with per-thread task queues and work stealing
+//
+// o Tasks are submitted in batches via run(tasks),
+//   which blocks until every task of the batch has
+//   finished. The calling thread helps execute tasks
+//   while it waits, so run may be called from inside
+//   a task without deadlocking.
+// o An ThreadPool of size n has n-1 worker threads
+//   (the calling thread counts as the n'th).
+//   For n <= 1 run just executes the tasks in order.
+// o If a task throws, the first exception is
+//   rethrown from run after the batch has finished.
+// o run(tasks,costs) takes an estimated cost
+//   (e.g. number of flops) for each task and
+//   assigns tasks largest-first to the least loaded
+//   thread; without costs tasks are dealt out
+//   round-robin. Either way idle threads steal
+//   work from busy ones.
+//
+
+class ThreadPool
+    {
+    public:
+    using Task = std::function<void()>;
+    private:
+    struct Batch;
+    struct Item
+        {
+        Task* task = nullptr;
+        Batch* batch = nullptr;
+        };
+    struct Queue
+        {
+        std::mutex m;
+        std::deque<Item> items;
+        };
+
+    int nthread_ = 1;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<long> pending_{0};
+    std::mutex sleep_m_;
+    std::condition_variable sleep_cv_;
+    bool stop_ = false;
+    std::atomic<long> next_queue_{0};
+    public:
+
+    explicit
+    ThreadPool(int nthread);
+
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const&) = delete;
+
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    int
+    nthread() const { return nthread_; }
+
+    void
+    run(std::vector<Task> & tasks);
+
+    void
+    run(std::vector<Task> & tasks,
+        std::vector<double> const& costs);
+
+    private:
+
+    void
+    runOn(std::vector<Task> & tasks,
+          std::vector<size_t> const& order,
+          std::vector<int> const& queue_of);
+
+    bool
+    tryPop(int q, Item & it);
+
+    bool
+    trySteal(int q, Item & it);
+
+    void
+    execute(Item const& it);
+
+    void
+    workerLoop(int q);
+    };
+
+//
+// Process-wide thread pool used by all of
+// the parallel code paths (QDense contraction,
+// large dense contractions, contractloop, ...)
+// so that threads are created once rather
+// than per call.
+// Its size is taken from the "NThread" value in
+// Args::global() or, if not defined there, from the
+// environment variable ITENSOR_NTHREAD (default 1).
+//
+ThreadPool&
+threadPool();
+
+//
+// Replace the process-wide thread pool
+// by one with nthread threads
+// (must not be called while the pool is in use)
+//
+void
+setNThread(int nthread);
+
+int inline
+getNThread() { return threadPool().nthread(); }
+
+//
+// Call f(n) for n = 0,1,...,costs.size()-1 using
+// at most maxthread threads of pool, handing out
+// the largest-cost calls first. The calls must be
+// independent of each other.
+// With maxthread <= 1 (or a single thread pool)
+// the calls are made in order on the calling thread.
+//
+template<typename Func>
+void
+parallelFor(ThreadPool & pool,
+            std::vector<double> const& costs,
+            int maxthread,
+            Func const& f)
+    {
+    auto N = costs.size();
+    auto nthread = std::min(pool.nthread(),maxthread);
+    if(nthread > int(N)) nthread = int(N);
+    if(nthread <= 1)
+        {
+        for(decltype(N) n = 0; n < N; ++n) f(n);
+        return;
+        }
+    auto tasks = std::vector<ThreadPool::Task>{};
+    if(nthread == pool.nthread())
+        {
+        tasks.reserve(N);
+        for(decltype(N) n = 0; n < N; ++n) tasks.emplace_back([&f,n]() { f(n); });
+        pool.run(tasks,costs);
+        return;
+        }
+    //Fewer threads than the pool has: bin the calls
+    //into nthread tasks (largest first, each into
+    //the least loaded bin) so that no more than
+    //nthread of them can run at once
+    auto order = std::vector<size_t>(N);
+    for(decltype(N) n = 0; n < N; ++n) order[n] = n;
+    std::stable_sort(order.begin(),order.end(),
+                     [&costs](size_t i, size_t j) { return costs[i] > costs[j]; });
+    auto bins = std::vector<std::vector<size_t>>(nthread);
+    auto load = std::vector<double>(nthread,0.);
+    for(auto n : order)
+        {
+        auto b = std::min_element(load.begin(),load.end())-load.begin();
+        load[b] += costs[n];
+        bins[b].push_back(n);
+        }
+    for(auto& bin : bins)
+        {
+        tasks.emplace_back([&f,&bin]() { for(auto n : bin) f(n); });
+        }
+    pool.run(tasks,load);
+    }
+
+} //namespace itensor
+
+#endif
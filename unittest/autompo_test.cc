@@ -4,6 +4,7 @@
 #include "itensor/mps/sites/fermion.h"
 #include "itensor/mps/sites/spinhalf.h"
 #include "itensor/util/print_macro.h"
+#include "itensor/util/threadpool.h"
 
 #include "ExpIsing.h"
 #include "ExpHeisenberg.h"
@@ -612,4 +613,66 @@ SECTION("Fermion")
         }
     }
 
+SECTION("Term Merging")
+    {
+    CHECK(opName(opId("Cdag")) == "Cdag");
+    CHECK(opId("Cdag") != opId("C"));
+
+    auto N = 6;
+    auto sites = Fermion(N);
+    auto ampo = AutoMPO(sites);
+    ampo += 0.5,"Cdag",1,"C",3;
+    ampo += 1.0,"N",2;
+    ampo += 0.25,"Cdag",1,"C",3;
+    CHECK(ampo.size() == 2);
+    //Terms are ordered by their operators, fewest first
+    auto& hop = *ampo.terms().rbegin();
+    CHECK(hop.first().op == "Cdag");
+    CHECK_CLOSE(hop.coef,0.75);
+
+    //A term made by assigning op is merged by its new op
+    auto ht = HTerm(0.25,SiteTermProd{SiteTerm("C",1),SiteTerm("C",3)});
+    ht.ops.front().op = "Cdag";
+    ampo.add(ht);
+    CHECK(ampo.size() == 2);
+    CHECK_CLOSE(ampo.terms().rbegin()->coef,1.0);
+
+    //All-to-all hopping with each term added twice
+    ampo.reset();
+    for(auto i : range1(N))
+    for(auto j : range1(N))
+        {
+        if(i == j) continue;
+        ampo += -0.5/(i+j),"Cdag",i,"C",j;
+        ampo += -0.5/(i+j),"Cdag",i,"C",j;
+        if(i < j) ampo += 0.1*i,"N",i,"N",j;
+        }
+    CHECK(ampo.size() == size_t(N*(N-1)+N*(N-1)/2));
+    auto H1 = toMPO(ampo);
+    auto nthread = getNThread();
+    setNThread(3);
+    auto H3 = toMPO(ampo);
+    setNThread(nthread);
+    CHECK(maxLinkDim(H3) == maxLinkDim(H1));
+    for(auto i : range1(N))
+    for(auto j : range1(N))
+        {
+        if(i == j) continue;
+        auto s1 = InitState(sites,"Emp");
+        s1.set(j,"Occ");
+        auto s2 = InitState(sites,"Emp");
+        s2.set(i,"Occ");
+        auto p1 = MPS(s1);
+        auto p2 = MPS(s2);
+        CHECK_CLOSE(inner(p2,H1,p1),-1./(i+j));
+        CHECK_CLOSE(inner(p2,H3,p1),-1./(i+j));
+        }
+    auto st = InitState(sites,"Emp");
+    st.set(2,"Occ");
+    st.set(5,"Occ");
+    auto psi = MPS(st);
+    CHECK_CLOSE(inner(psi,H1,psi),0.2);
+    CHECK_CLOSE(inner(psi,H3,psi),0.2);
+    }
+
 }
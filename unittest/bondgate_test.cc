@@ -1,101 +1,192 @@
 #include "test.h"
-#include "bondgate.h"
-#include "sites/spinhalf.h"
+#include "itensor/mps/bondgate.h"
+#include "itensor/mps/tevol.h"
+#include "itensor/util/threadpool.h"
+#include "itensor/mps/sites/spinhalf.h"
 
 using std::vector;
 using namespace itensor;
 
+//exp(t*H) from a 100 term Taylor series,
+//the way BondGate used to make gates
+ITensor
+taylorExp(SiteSet const& sites,
+          int i1,
+          int i2,
+          Cplx t,
+          ITensor H)
+    {
+    H *= t;
+    auto unit = sites.op("Id",i1)*sites.op("Id",i2);
+    auto term = H;
+    H.replaceTags("1","2");
+    H.replaceTags("0","1");
+    ITensor gate;
+    for(int ord = 100; ord >= 1; --ord)
+        {
+        term /= ord;
+        gate = unit + term;
+        term = gate * H;
+        term.replaceTags("2","1");
+        }
+    return gate;
+    }
+
+ITensor
+heisenberg(SiteSet const& sites,
+           int s1,
+           int s2)
+    {
+    auto hh = sites.op("Sz",s1)*sites.op("Sz",s2);
+    hh += sites.op("S-",s1)*sites.op("S+",s2) * 0.5;
+    hh += sites.op("S+",s1)*sites.op("S-",s2) * 0.5;
+    return hh;
+    }
+
 TEST_CASE("BondGateTest")
 {
 
 const int N = 10;
-SpinHalf sites(N);
+auto sites = SpinHalf(N,{"ConserveQNs=",true});
 
 SECTION("Site Accessors")
     {
-    Gate g1(sites,1,2);
+    BondGate g1(sites,1,2);
     CHECK(g1.i1() < g1.i2());
 
-    Gate g2(sites,2,1);
+    BondGate g2(sites,2,1);
     CHECK(g2.i1() < g2.i2());
 
     const int s1 = 3, s2 = 4;
-    ITensor hh =  sites.op("Sz",s1)*sites.op("Sz",s2);
-    hh += sites.op("Sm",s1)*sites.op("Sp",s2) * 0.5;
-    hh += sites.op("Sp",s1)*sites.op("Sm",s2) * 0.5;
+    auto hh = heisenberg(sites,s1,s2);
 
-    Gate g3(sites,s1,s2,Gate::tImag,0.1,hh);
+    BondGate g3(sites,s1,s2,BondGate::tImag,0.1,hh);
     CHECK(g3.i1() < g3.i2());
 
-    Gate g4(sites,s2,s1,Gate::tImag,0.1,hh);
+    BondGate g4(sites,s2,s1,BondGate::tImag,0.1,hh);
     CHECK(g4.i1() < g4.i2());
     }
 
 SECTION("SwapGate")
     {
-    Gate sw12(sites,1,2);
-    ITensor id = multSiteOps(sw12.gate(),sw12.gate());
-    CHECK((id-sites.op("Id",1)*sites.op("Id",2)).norm() < 1E-12);
-
-    IQGate qsw12(sites,1,2);
-    IQTensor qid = multSiteOps(qsw12.gate(),qsw12.gate());
-    CHECK((qid-sites.op("Id",1)*sites.op("Id",2)).norm() < 1E-12);
+    BondGate sw12(sites,1,2);
+    auto id = multSiteOps(sw12.gate(),sw12.gate());
+    CHECK(norm(id-sites.op("Id",1)*sites.op("Id",2)) < 1E-12);
     }
 
 SECTION("ImagTimeGates")
     {
-    vector<IQTensor> H(N+1);
+    const Real tau = 0.01;
     for(int b = 1; b < N; ++b)
         {
-        const int s1 = b;
-        const int s2 = s1+1;
-        IQTensor& hh = H.at(b);
-
-        //Heisenberg model
-        hh =  sites.op("Sz",s1)*sites.op("Sz",s2) * 1;
-        hh += sites.op("Sm",s1)*sites.op("Sp",s2) * 0.5;
-        hh += sites.op("Sp",s1)*sites.op("Sm",s2) * 0.5;
+        auto hh = heisenberg(sites,b,b+1);
+        auto g = BondGate(sites,b,b+1,BondGate::tImag,tau/2.,hh);
+        CHECK(hasQNs(g.gate()));
+        CHECK(norm(g.gate()-taylorExp(sites,b,b+1,-tau/2.,hh)) < 1E-12);
         }
+    }
 
-    vector<IQGate> gates;
-    const IQGate::Type type = IQGate::tImag;
-
-    const Real tau = 0.01;
+SECTION("RealTimeGate")
+    {
+    const Real tau = 0.1;
     for(int b = 1; b < N; ++b)
         {
-        const int s1 = b;
-        const int s2 = s1+1;
-        const IQTensor& hh = H.at(b);
-        gates.push_back(IQGate(sites,s1,s2,type,tau/2.,hh));
+        auto hh = heisenberg(sites,b,b+1);
+        auto g = BondGate(sites,b,b+1,BondGate::tReal,tau/2.,hh);
+        CHECK(norm(g.gate()-taylorExp(sites,b,b+1,Cplx(0.,-tau/2.),hh)) < 1E-12);
+        //Gate is unitary
+        auto u = multSiteOps(swapPrime(dag(g.gate()),0,1),g.gate());
+        CHECK(norm(u-sites.op("Id",b)*sites.op("Id",b+1)) < 1E-12);
         }
     }
 
-SECTION("RealTimeGate")
+SECTION("Non-Hermitian Bond Hamiltonian")
     {
-    vector<IQTensor> H(N+1);
-    for(int b = 1; b < N; ++b)
+    auto hh = sites.op("Sz",2)*sites.op("Sz",3);
+    hh += sites.op("S-",2)*sites.op("S+",3) * 0.9;
+    hh += sites.op("S+",2)*sites.op("S-",3) * 0.2;
+    //Large tau*H needs several squarings
+    for(auto tau : {0.05,1.5})
         {
-        const int s1 = b;
-        const int s2 = s1+1;
-        IQTensor& hh = H.at(b);
-
-        //Heisenberg model
-        hh =  sites.op("Sz",s1)*sites.op("Sz",s2) * 1;
-        hh += sites.op("Sm",s1)*sites.op("Sp",s2) * 0.5;
-        hh += sites.op("Sp",s1)*sites.op("Sm",s2) * 0.5;
+        auto g = BondGate(sites,2,3,BondGate::tImag,tau,4*hh);
+        auto ref = taylorExp(sites,2,3,-tau,4*hh);
+        CHECK(norm(g.gate()-ref) < 1E-10*norm(ref));
+        auto gr = BondGate(sites,2,3,BondGate::tReal,tau,hh);
+        auto refr = taylorExp(sites,2,3,Cplx(0.,-tau),hh);
+        CHECK(norm(gr.gate()-refr) < 1E-10*norm(refr));
         }
+    }
 
-    vector<IQGate> gates;
-    const IQGate::Type type = IQGate::tReal;
+SECTION("Gate Cache")
+    {
+    clearBondGateCache();
+    auto hh = heisenberg(sites,4,5);
+    auto g1 = BondGate(sites,4,5,BondGate::tImag,0.1,hh);
+    CHECK(bondGateCacheStats().misses == 1);
+    CHECK(bondGateCacheStats().hits == 0);
+
+    auto g2 = BondGate(sites,4,5,BondGate::tImag,0.1,hh);
+    CHECK(bondGateCacheStats().hits == 1);
+    CHECK(norm(g1.gate()-g2.gate()) == 0.);
+
+    //Different tau, type, or Hamiltonian
+    //give a new gate
+    auto g3 = BondGate(sites,4,5,BondGate::tImag,0.05,hh);
+    auto g4 = BondGate(sites,4,5,BondGate::tReal,0.1,hh);
+    auto g5 = BondGate(sites,4,5,BondGate::tImag,0.1,2*hh);
+    CHECK(bondGateCacheStats().hits == 1);
+    CHECK(bondGateCacheStats().misses == 4);
+    CHECK(norm(g3.gate()-g1.gate()) > 1E-3);
+    CHECK(norm(g5.gate()-g1.gate()) > 1E-3);
+
+    clearBondGateCache();
+    CHECK(bondGateCacheStats().misses == 0);
+    }
 
-    const Real tau = 0.01;
-    for(int b = 1; b < N; ++b)
+
+SECTION("Parallel gateTEvol")
+    {
+    //Brickwork list: odd bonds, then even bonds
+    auto brickwork = [&sites](BondGate::Type type, Real tau)
+        {
+        auto gates = vector<BondGate>{};
+        for(int start : {1,2})
+        for(int b = start; b < N; b += 2)
+            {
+            gates.push_back(BondGate(sites,b,b+1,type,tau,heisenberg(sites,b,b+1)));
+            }
+        return gates;
+        };
+    auto init = InitState(sites);
+    for(auto j : range1(N)) init.set(j,j%2==1 ? "Up" : "Dn");
+    auto psi0 = MPS(init);
+
+    auto nthread = getNThread();
+    setNThread(3);
+    auto args = Args("Cutoff=",1E-14,"MaxDim=",100,"ShowPercent=",false);
+    for(auto type : {BondGate::tReal,BondGate::tImag})
         {
-        const int s1 = b;
-        const int s2 = s1+1;
-        const IQTensor& hh = H.at(b);
-        gates.push_back(IQGate(sites,s1,s2,type,tau/2.,hh));
+        auto gates = brickwork(type,0.05);
+        auto psi1 = psi0;
+        auto nrm1 = gateTEvol(gates,0.5,0.05,psi1,args);
+        auto psi2 = psi0;
+        auto nrm2 = gateTEvol(gates,0.5,0.05,psi2,{args,"Method=","Parallel"});
+        CHECK(hasQNs(psi2));
+        CHECK(std::abs(innerC(psi1,psi2)) == Approx(1.).epsilon(1E-9));
+        CHECK(norm(psi2) == Approx(1.).epsilon(1E-9));
+        CHECK(nrm2 == Approx(nrm1).epsilon(1E-7));
         }
+
+    //Truncation is applied the same way
+    auto gates = brickwork(BondGate::tImag,0.1);
+    auto psi1 = psi0;
+    gateTEvol(gates,1.,0.1,psi1,{args,"MaxDim=",4});
+    auto psi2 = psi0;
+    gateTEvol(gates,1.,0.1,psi2,{args,"MaxDim=",4,"Method=","Parallel"});
+    CHECK(maxLinkDim(psi2) <= 4);
+    CHECK(maxLinkDim(psi2) == maxLinkDim(psi1));
+    CHECK(std::abs(innerC(psi1,psi2)) > 0.99);
+    setNThread(nthread);
     }
 
 }
@@ -4,6 +4,7 @@
 #include "itensor/tensor/contract.h"
 #include "itensor/util/set_scoped.h"
 #include "itensor/util/args.h"
+#include "itensor/util/threadpool.h"
 #include "itensor/global.h"
 
 using namespace itensor;
@@ -792,4 +793,193 @@ TEST_CASE("Contract Test")
 #endif
     
         } // Contract Loop
+
+    SECTION("Contract Plan Cache")
+        {
+        Tensor A(3,4,5),
+               B(5,4,2),
+               C1(3,2),
+               C2(3,2);
+        randomize(A);
+        randomize(B);
+        clearContractPlanCache();
+        contract(A,{1,2,3},B,{3,2,4},C1,{1,4});
+        auto s1 = contractPlanCacheStats();
+        CHECK(s1.misses == 1);
+        CHECK(s1.hits == 0);
+        //Same shape again: plan is reused
+        contract(A,{1,2,3},B,{3,2,4},C2,{1,4});
+        auto s2 = contractPlanCacheStats();
+        CHECK(s2.misses == 1);
+        CHECK(s2.hits == 1);
+        for(auto i1 : range(3))
+        for(auto i4 : range(2))
+            {
+            CHECK_CLOSE(C1(i1,i4),C2(i1,i4));
+            }
+        //Different output order: new plan
+        Tensor D(2,3);
+        contract(A,{1,2,3},B,{3,2,4},D,{4,1});
+        CHECK(contractPlanCacheStats().misses == 2);
+        for(auto i1 : range(3))
+        for(auto i4 : range(2))
+            {
+            CHECK_CLOSE(D(i4,i1),C1(i1,i4));
+            }
+        }
+
+    SECTION("Packed Contraction")
+        {
+        SECTION("Permuted A, B, and C")
+            {
+            Tensor A(2,3,4,5,6,7),
+                   B(8,7,5,6,9),
+                   C1(4,9,2,3,8),
+                   C2(4,9,2,3,8);
+            randomize(A);
+            randomize(B);
+            contract(makeRef(B),{8,7,5,6,9},makeRef(A),{2,3,4,5,6,7},makeRef(C1),{4,9,2,3,8},1.,0.,ContractMethod::Permute);
+            contract(makeRef(B),{8,7,5,6,9},makeRef(A),{2,3,4,5,6,7},makeRef(C2),{4,9,2,3,8},1.,0.,ContractMethod::Packed);
+            for(auto n : range(C1.size()))
+                {
+                CHECK_CLOSE(C1.store()[n],C2.store()[n]);
+                }
+            }
+
+        SECTION("Several Panels, alpha and beta")
+            {
+            //Row, column, and contracted dimensions
+            //larger than a single panel
+            Tensor A(150,18,16),
+                   B(18,270,16),
+                   C1(270,150),
+                   C2(270,150);
+            randomize(A);
+            randomize(B);
+            randomize(C1);
+            for(auto n : range(C1.size())) C2.store()[n] = C1.store()[n];
+            contract(makeRef(A),{1,2,3},makeRef(B),{2,4,3},makeRef(C1),{4,1},0.5,2.,ContractMethod::Permute);
+            contract(makeRef(A),{1,2,3},makeRef(B),{2,4,3},makeRef(C2),{4,1},0.5,2.,ContractMethod::Packed);
+            for(auto n : range(C1.size()))
+                {
+                CHECK_CLOSE(C1.store()[n],C2.store()[n]);
+                }
+            }
+
+        SECTION("Complex")
+            {
+            CTensor A(4,3,5),
+                    C1(6,4),
+                    C2(6,4);
+            Tensor B(5,6,3);
+            for(auto& el : A) el = Cplx(Global::random(),Global::random());
+            randomize(B);
+            contract(makeRef(A),{1,2,3},makeRef(B),{3,4,2},makeRef(C1),{4,1},1.,0.,ContractMethod::Permute);
+            contract(makeRef(A),{1,2,3},makeRef(B),{3,4,2},makeRef(C2),{4,1},1.,0.,ContractMethod::Packed);
+            for(auto n : range(C1.size()))
+                {
+                CHECK_CLOSE(C1.store()[n],C2.store()[n]);
+                }
+            }
+
+        SECTION("Global Default")
+            {
+            CHECK(getContractMethod() == ContractMethod::Permute);
+            Tensor A(3,4,5),
+                   B(5,4,2),
+                   C1(2,3),
+                   C2(2,3);
+            randomize(A);
+            randomize(B);
+            contract(A,{1,2,3},B,{3,2,4},C1,{4,1});
+            setContractMethod(ContractMethod::Packed);
+            CHECK(getContractMethod() == ContractMethod::Packed);
+            contract(A,{1,2,3},B,{3,2,4},C2,{4,1});
+            setContractMethod(ContractMethod::Permute);
+            for(auto n : range(C1.size()))
+                {
+                CHECK_CLOSE(C1.store()[n],C2.store()[n]);
+                }
+            }
+        }
+
+    SECTION("Parallel Contraction")
+        {
+        auto size = getContractParallelSize();
+        auto nthread = getNThread();
+        setContractParallelSize(0);
+
+        auto checkSame = [](auto const& C1, auto const& C2)
+            {
+            for(auto n : range(C1.size()))
+                {
+                CHECK_CLOSE(C1.store()[n],C2.store()[n]);
+                }
+            };
+
+        SECTION("Permuted, More Rows Than Columns")
+            {
+            Tensor A(40,30,25),
+                   B(25,6,30),
+                   C1(6,40),
+                   C2(6,40);
+            randomize(A);
+            randomize(B);
+            randomize(C1);
+            for(auto n : range(C1.size())) C2.store()[n] = C1.store()[n];
+            setNThread(1);
+            contract(makeRef(A),{1,2,3},makeRef(B),{3,4,2},makeRef(C1),{4,1},0.5,2.);
+            setNThread(4);
+            contract(makeRef(A),{1,2,3},makeRef(B),{3,4,2},makeRef(C2),{4,1},0.5,2.);
+            checkSame(C1,C2);
+            }
+
+        SECTION("Permuted, More Columns Than Rows")
+            {
+            Tensor A(7,30,25),
+                   B(25,60,30),
+                   C1(60,7),
+                   C2(60,7);
+            randomize(A);
+            randomize(B);
+            setNThread(1);
+            contract(A,{1,2,3},B,{3,4,2},C1,{4,1});
+            setNThread(4);
+            contract(A,{1,2,3},B,{3,4,2},C2,{4,1});
+            checkSame(C1,C2);
+            }
+
+        SECTION("Matrix Layout")
+            {
+            Tensor A(50,40,30),
+                   B(30,45),
+                   C1(50,40,45),
+                   C2(50,40,45);
+            randomize(A);
+            randomize(B);
+            setNThread(1);
+            contract(A,{1,2,3},B,{3,4},C1,{1,2,4});
+            setNThread(3);
+            contract(A,{1,2,3},B,{3,4},C2,{1,2,4});
+            checkSame(C1,C2);
+            }
+
+        SECTION("Complex")
+            {
+            CTensor A(30,20,40),
+                    C1(35,30),
+                    C2(35,30);
+            Tensor B(40,35,20);
+            for(auto& el : A) el = Cplx(Global::random(),Global::random());
+            randomize(B);
+            setNThread(1);
+            contract(A,{1,2,3},B,{3,4,2},C1,{4,1});
+            setNThread(4);
+            contract(A,{1,2,3},B,{3,4,2},C2,{4,1});
+            checkSame(C1,C2);
+            }
+
+        setNThread(nthread);
+        setContractParallelSize(size);
+        }
     }
@@ -1,6 +1,7 @@
 #include "test.h"
 #include "itensor/decomp.h"
 #include "itensor/util/print_macro.h"
+#include "itensor/util/threadpool.h"
 
 using namespace itensor;
 using namespace std;
@@ -437,6 +438,86 @@ SECTION("ITensor diagHermitian (with QNs)")
         }
     }
 
+SECTION("QN ITensor SVD Methods")
+    {
+    auto L = Index(QN(+1),4,
+                   QN( 0),6,
+                   QN(-1),3,"L");
+    auto S = Index(QN(+1),1,
+                   QN(-1),1,"S");
+    auto A = randomITensorC(QN(),L,S,prime(L));
+    auto [U0,S0,V0] = svd(A,{L,S});
+    for(auto method : {"gesdd","gesvd"})
+        {
+        auto [U,D,V] = svd(A,{L,S},{"SVDMethod",method});
+        CHECK(norm(U*D*V-A) < 1E-12);
+        CHECK(std::abs(norm(D)-norm(S0)) < 1E-12);
+        }
+    }
+
+SECTION("Randomized SVD")
+    {
+    auto L = Index(QN(+1),20,
+                   QN( 0),30,
+                   QN(-1),20,"L");
+    auto S = Index(QN(+1),1,
+                   QN(-1),1,"S");
+    auto A = randomITensor(QN(),L,S,prime(L));
+    ITensor U0(L,S),S0,V0;
+    auto spec0 = svd(A,U0,S0,V0,{"MaxDim",8});
+    ITensor U(L,S),D,V;
+    auto spec = svd(A,U,D,V,{"MaxDim",8,"SVDRandomized",true,"SVDPowerIter",4});
+    CHECK(dim(commonIndex(U,D)) == 8);
+    //Truncation error includes the singular
+    //values which were never computed
+    CHECK(std::abs(spec.truncerr()-spec0.truncerr()) < 1E-2*spec0.truncerr());
+    auto err0 = sqr(norm(U0*S0*V0-A));
+    CHECK(std::abs(sqr(norm(U*D*V-A))-err0) < 1E-2*err0);
+
+    //Dense case
+    auto i = Index(40,"i"),
+         j = Index(50,"j");
+    auto B = randomITensor(i,j);
+    auto [UB0,SB0,VB0] = svd(B,{i},{"MaxDim",5});
+    auto [UB,SB,VB] = svd(B,{i},{"MaxDim",5,"SVDRandomized",true});
+    CHECK(dim(commonIndex(UB,SB)) == 5);
+    auto errB0 = sqr(norm(UB0*SB0*VB0-B));
+    CHECK(std::abs(sqr(norm(UB*SB*VB-B))-errB0) < 1E-2*errB0);
+    }
+
+SECTION("Threaded Block Decompositions")
+    {
+    auto L = Index(QN(+2),3,
+                   QN(+1),7,
+                   QN( 0),10,
+                   QN(-1),6,
+                   QN(-2),2,"L");
+    auto S = Index(QN(+1),1,
+                   QN(-1),1,"S");
+    auto A = randomITensor(QN(),L,S,prime(L));
+    auto H = randomITensor(QN(),dag(L),prime(L));
+    H += swapTags(dag(H),"0","1");
+
+    setNThread(1);
+    auto [U1,S1,V1] = svd(A,{L,S},{"MaxDim",12});
+    auto [UH1,DH1] = diagHermitian(H);
+
+    setNThread(4);
+    //All pool threads, then at most two
+    for(auto nt : {4,2})
+        {
+        auto [U2,S2,V2] = svd(A,{L,S},{"MaxDim",12,"DecompNThread",nt});
+        CHECK(norm(U2*S2*V2-U1*S1*V1) < 1E-12);
+        CHECK(std::abs(norm(S2)-norm(S1)) < 1E-12);
+        CHECK(dim(commonIndex(U2,S2)) == dim(commonIndex(U1,S1)));
+
+        auto [UH2,DH2] = diagHermitian(H,{"DecompNThread",nt});
+        CHECK(norm(H-dag(UH2)*DH2*prime(UH2)) < 1E-12);
+        CHECK(std::abs(norm(DH2)-norm(DH1)) < 1E-12);
+        }
+    setNThread(1);
+    }
+
 SECTION("Truncating (Special Cases)")
   {
   SECTION("All zeros")
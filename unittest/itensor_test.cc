@@ -1,9 +1,13 @@
 #include "test.h"
 #include "itensor/itensor.h"
+#include "itensor/tensorfile.h"
+#include "itensor/contractsequence.h"
 #include "itensor/util/cplx_literal.h"
 #include "itensor/util/iterate.h"
 #include "itensor/util/set_scoped.h"
 #include "itensor/util/print_macro.h"
+#include "itensor/util/threadpool.h"
+#include "itensor/itdata/qutil.h"
 #include <cstdlib>
 
 using namespace std;
@@ -349,6 +353,84 @@ SECTION("QDense Real Storage")
 std::system(format("rm -f %s",fname).c_str());
 }
 
+SECTION("Mapped Tensor Files")
+{
+auto fname = std::string("_mapped_test");
+SECTION("Dense Storage")
+    {
+    auto T = randomITensor(s1,s2);
+    T *= 3.;
+    writeToMappedFile(fname,T);
+    CHECK(isMappedFile(fname));
+    auto nT = readFromMappedFile(fname);
+    CHECK(typeOf(nT) == Type::DenseReal);
+    CHECK(norm(T-nT) < 1E-12);
+
+    //Data is read straight from the mapping
+    auto M = MappedTensorFile(fname);
+    CHECK(M.type() == StorageType::DenseReal);
+    CHECK(M.size() == 4);
+    CHECK(hasIndex(M.inds(),s1));
+    auto p = M.realData();
+    CHECK(reinterpret_cast<size_t>(p) % 4096 == 0);
+    auto U = T;
+    U.scaleTo(1.);
+    CHECK_CLOSE(p[0],elt(U,s1=1,s2=1));
+    CHECK_CLOSE(p[3],elt(U,s1=2,s2=2));
+    CHECK_THROWS_AS(M.cplxData(),ITError);
+
+    auto TC = randomITensorC(s1,s2);
+    writeToMappedFile(fname,TC);
+    CHECK(norm(TC-readFromMappedFile(fname)) < 1E-12);
+    }
+SECTION("QDense Storage")
+    {
+    auto i = Index(QN(0),2,QN(-1),2,In,"i,Site");
+    auto j = Index(QN(0),2,QN(-1),3,Out,"j,Site");
+    for(auto T : {randomITensor(QN(0),i,j),randomITensorC(QN(-1),i,j)})
+        {
+        writeToMappedFile(fname,T);
+        auto nT = readFromMappedFile(fname);
+        CHECK(hasQNs(nT));
+        CHECK(isComplex(nT) == isComplex(T));
+        CHECK(norm(T-nT) < 1E-12);
+        auto M = MappedTensorFile(fname);
+        CHECK(!M.offsets().empty());
+        }
+    }
+SECTION("Other Storage and Legacy Files")
+    {
+    auto [C,ci] = combiner(s1,s2);
+    writeToMappedFile(fname,C);
+    auto nC = readFromMappedFile(fname);
+    CHECK(typeOf(nC) == Type::Combiner);
+    CHECK(hasIndex(nC,ci));
+
+    writeToMappedFile(fname,ITensor{});
+    CHECK(!readFromMappedFile(fname));
+
+    //Files from writeToFile are still readable
+    auto T = randomITensor(s1,s2);
+    writeToFile(fname,T);
+    CHECK(!isMappedFile(fname));
+    CHECK(norm(T-readFromMappedFile(fname)) < 1E-12);
+    CHECK_THROWS_AS(MappedTensorFile(fname),ITError);
+    }
+SECTION("Replace Rather Than Overwrite")
+    {
+    auto T1 = randomITensor(s1,s2);
+    auto T2 = randomITensor(s1,s2);
+    writeToMappedFile(fname,T1);
+    auto link = fname + "_link";
+    std::system(format("ln -f %s %s",fname,link).c_str());
+    writeToMappedFile(fname,T2);
+    CHECK(norm(T1-readFromMappedFile(link)) < 1E-12);
+    CHECK(norm(T2-readFromMappedFile(fname)) < 1E-12);
+    std::system(format("rm -f %s",link).c_str());
+    }
+std::system(format("rm -f %s",fname).c_str());
+}
+
 SECTION("Set and Get Elements")
 {
 auto T = ITensor(s1,s2);
@@ -1765,6 +1847,75 @@ SECTION("replaceInds (QNs)")
       }
     }
 
+SECTION("Parallel QN Contraction")
+    {
+    auto A = randomITensor(QN(),L1,S1,S2,prime(L2));
+    auto B = randomITensor(QN(),dag(prime(L2)),dag(S2),S3,L2);
+    auto nthread = getNThread();
+    setNThread(1);
+    auto C1 = A*B;
+    setNThread(4);
+    auto C4 = A*B;
+    setNThread(nthread);
+    CHECK(hasInds(inds(C4),inds(C1)));
+    CHECK(norm(C1-C4) < 1E-12*norm(C1));
+    }
+
+SECTION("QN Contraction Plan Cache")
+    {
+    auto A = randomITensor(QN(),L1,S1,S2,prime(L2));
+    auto B = randomITensor(QN(),dag(prime(L2)),dag(S2),S3,L2);
+    clearBlockContractPlanCache();
+    auto C1 = A*B;
+    CHECK(blockContractPlanCacheStats().misses == 1);
+    CHECK(blockContractPlanCacheStats().hits == 0);
+    //New data, same structure: plan is reused
+    auto A2 = randomITensor(QN(),L1,S1,S2,prime(L2));
+    auto C2 = A2*B;
+    CHECK(blockContractPlanCacheStats().hits == 1);
+    auto C2check = A2*B;
+    CHECK(norm(C2-C2check) < 1E-12*norm(C2));
+    for(auto l1 : range1(dim(L1)))
+    for(auto s1 : range1(dim(S1)))
+    for(auto s3 : range1(dim(S3)))
+    for(auto l2 : range1(dim(L2)))
+        {
+        auto val = 0.;
+        for(auto s2 : range1(dim(S2)))
+        for(auto l2p : range1(dim(L2)))
+            {
+            val += elt(A2,L1=l1,S1=s1,S2=s2,prime(L2)=l2p)*elt(B,prime(L2)=l2p,S2=s2,S3=s3,L2=l2);
+            }
+        CHECK_CLOSE(elt(C2,L1=l1,S1=s1,S3=s3,L2=l2),val);
+        }
+    }
+
+SECTION("QDense Block Table")
+    {
+    auto is = IndexSet(L1,S1,S2,prime(L2));
+    auto dA = QDenseReal(is,QN());
+    auto tab = dA.blockTable(is);
+    CHECK(tab->blockinds.size() == dA.offsets.size());
+    for(auto n : range(dA.offsets.size()))
+        {
+        auto block = Labels(order(is));
+        computeBlockInd(dA.offsets[n].block,is,block);
+        for(auto j : range(order(is))) CHECK(tab->blockinds[n][j] == block[j]);
+        CHECK(tab->find(dA.offsets[n].block) == long(n));
+        }
+    //Copies share the table
+    auto dB = dA;
+    CHECK(dB.blockTable(is) == tab);
+    //Reading from a stream rebuilds it
+    auto ss = std::stringstream{};
+    write(ss,dA);
+    auto dC = QDenseReal{};
+    read(ss,dC);
+    auto ctab = dC.blockTable(is);
+    CHECK(ctab != tab);
+    CHECK(ctab->position == tab->position);
+    }
+
 SECTION("Diag ITensor Contraction")
 {
 SECTION("Diag All Same")
@@ -2674,6 +2825,66 @@ SECTION("ITensor toDense function")
     }
   }
 
+SECTION("contractSequence")
+  {
+  clearContractSequenceCache();
+
+  SECTION("Matches Left to Right")
+    {
+    auto A = randomITensor(b2,b3),
+         B = randomITensor(b4,b5),
+         C = randomITensor(b3,b4,b6);
+    auto R = contractSequence({A,B,C});
+    CHECK(norm(R-A*B*C) < 1E-12*norm(R));
+    //A*B is an outer product, so contract C first
+    auto o = contractOrder({A,B,C});
+    CHECK(o.size() == 2);
+    CHECK(o.front() != std::make_pair(0,1));
+
+    //Same shape, other indices: order is cached
+    auto b3a = sim(b3), b4a = sim(b4);
+    auto R2 = contractSequence({randomITensor(b2,b3a),randomITensor(b4a,b5),randomITensor(b3a,b4a,b6)});
+    CHECK(hasIndex(R2,b6));
+    CHECK(contractSequenceCacheStats().hits >= 1);
+    }
+
+  SECTION("Index on Three Tensors")
+    {
+    auto A = randomITensor(b2,b3),
+         B = randomITensor(b3,b4),
+         C = randomITensor(b3,b4,b5);
+    auto o = contractOrder({A,B,C});
+    CHECK(o.front() == std::make_pair(0,1));
+    CHECK(norm(contractSequence({A,B,C})-A*B*C) < 1E-12);
+    }
+
+  SECTION("Long Chain")
+    {
+    //Closed ring of 8 complex matrices,
+    //ordered by the greedy search
+    auto l = std::vector<Index>{b2,b7,b3,b8,b4,b6,b5,l1};
+    auto ts = std::vector<ITensor>{};
+    for(auto n : range(l)) ts.push_back(randomITensorC(l[n],l[(n+3)%l.size()]));
+    auto ref = ts[0];
+    for(auto n : range1(ts.size()-1)) ref *= ts[n];
+    auto R = contractSequence(ts);
+    CHECK(order(R) == 0);
+    CHECK(std::abs(eltC(R)-eltC(ref)) < 1E-12*std::abs(eltC(ref)));
+    }
+
+  SECTION("QN Tensors")
+    {
+    auto A = randomITensor(QN(),L1,S1,prime(L1,2)),
+         W = randomITensor(QN(),dag(S1),prime(S1),L2),
+         B = randomITensor(QN(),dag(L1),dag(prime(S1)),dag(L2),prime(L2,3));
+    auto R = contractSequence({A,W,B});
+    CHECK(hasQNs(R));
+    CHECK(norm(R-A*W*B) < 1E-12*norm(R));
+    }
+
+  CHECK_THROWS_AS(contractSequence({}),ITError);
+  }
+
 } //TEST_CASE("ITensor")
 
 
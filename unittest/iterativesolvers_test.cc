@@ -1,9 +1,11 @@
 #include "test.h"
 #include "itensor/iterativesolvers.h"
+#include "itensor/flatvector.h"
 #include "sample/Heisenberg.h"
 #include "itensor/mps/sites/spinhalf.h"
 #include "itensor/mps/localmpo.h"
 #include "itensor/mps/autompo.h"
+#include "SpectraItensor/expApplyH.h"
 
 using namespace itensor;
 using namespace std;
@@ -45,6 +47,67 @@ class ITensorMap
 
     };
 
+//ITensorMap with the productnext method
+//expApplyH expects (ignoring the direction)
+class ExpITensorMap : public ITensorMap
+    {
+    public:
+
+    ExpITensorMap(ITensor const& A) : ITensorMap(A) { }
+
+    void
+    productnext(ITensor const& x, ITensor& b, Direction) const { product(x,b); }
+    };
+
+//ITensorMap with a productBatch method,
+//counting how often it is called
+class BatchedITensorMap : public ITensorMap
+    {
+    public:
+    mutable int nbatch = 0;
+
+    BatchedITensorMap(ITensor const& A) : ITensorMap(A) { }
+
+    void
+    productBatch(std::vector<ITensor> const& x, std::vector<ITensor>& b) const
+        {
+        ++nbatch;
+        b.resize(x.size());
+        for(auto n : range(x.size())) product(x[n],b[n]);
+        }
+    };
+
+//Spin-half chain with complex XY couplings and a Neel
+//state entangled by napply applications of H, with its
+//orthogonality center at N/2
+void
+complexChain(int N,
+             int napply,
+             MPO & H,
+             MPS & psi)
+    {
+    auto sites = SpinHalf(N);
+    auto ampo = AutoMPO(sites);
+    for(int j = 1; j < N; ++j)
+        {
+        ampo += Cplx(0.5,0.2),"S+",j,"S-",j+1;
+        ampo += Cplx(0.5,-0.2),"S-",j,"S+",j+1;
+        ampo +=     "Sz",j,"Sz",j+1;
+        }
+    H = toMPO(ampo);
+    auto initState = InitState(sites);
+    for(int i = 1; i <= N; ++i)
+        initState.set(i,i%2==1 ? "Up" : "Dn");
+    psi = MPS(initState);
+    for(int j = 1; j <= napply; ++j)
+        {
+        psi = applyMPO(H,psi);
+        psi.noPrime();
+        psi.normalize();
+        }
+    psi.position(N/2);
+    }
+
 TEST_CASE("EigenSolverTest")
 {
 
@@ -363,4 +426,222 @@ SECTION("Arnoldi (QN)")
 
     }
 
+
+SECTION("Flat Vector View")
+    {
+    auto s = Index(QN(-1),1,
+                   QN(+1),1,"s");
+    auto l = Index(QN(+1),2,
+                   QN( 0),2,
+                   QN(-1),2,"l");
+    auto r = Index(QN(+1),2,
+                   QN( 0),2,
+                   QN(-1),2,"r");
+    //Only two of the blocks allowed by the flux
+    auto T0 = ITensor(l,s,r);
+    T0.set(l=1,s=2,r=5,1.5);
+    T0.set(l=3,s=2,r=4,-2.5);
+    auto L = FlatLayout(T0);
+    CHECK(L.hasQNs());
+    CHECK(L.size() == 16);
+
+    auto T = T0;
+    auto F = flatView<Real>(T,L);
+    CHECK(F.size() == L.size());
+    CHECK(norm(F) == Approx(norm(T0)));
+    CHECK(norm(T-T0) < 1E-14);
+    CHECK(norm(toITensor(makeRefc(F),L)-T0) < 1E-14);
+    //Already in the layout: a view of the same data
+    CHECK(flatView<Real>(T,L).data() == F.data());
+
+    //Permuted and rescaled copies give the same vector
+    auto P = 2.*permute(T0,r,s,l);
+    auto FP = flatView<Real>(P,L);
+    for(auto n : range(L.size())) CHECK_CLOSE(FP(n),2.*F(n));
+
+    //Conversion to complex
+    auto TC = T0;
+    auto FC = flatView<Cplx>(TC,L);
+    CHECK(isComplex(TC));
+    for(auto n : range(L.size())) CHECK_CLOSE(FC(n),F(n));
+
+    //Elements outside of the layout
+    auto W = ITensor(l,s,r);
+    W.set(l=1,s=1,r=5,1.);
+    CHECK_THROWS_AS(flatView<Real>(W,L),ITError);
+
+    //Layout without QNs
+    auto a = Index(3,"a"),
+         b = Index(4,"b");
+    auto D = randomITensorC(a,b);
+    auto LD = FlatLayout(D);
+    auto DT = permute(D,b,a);
+    auto FD = flatView<Cplx>(DT,LD);
+    CHECK(FD.size() == 12);
+    CHECK(norm(toITensor(makeRefc(FD),LD)-D) < 1E-14);
+
+    //Basis operations
+    auto M = randomMatC(12,3);
+    auto x = randomCVec(12);
+    auto ov = CVector(3);
+    multDag(M,x,ov);
+    for(auto k : range(3))
+        {
+        auto z = Cplx(0.);
+        for(auto n : range(12)) z += std::conj(M(n,k))*x(n);
+        CHECK_CLOSE(ov(k),z);
+        }
+    auto y = x;
+    axpy(Cplx(0.5,-1.),column(M,1),makeRef(y));
+    for(auto n : range(12)) CHECK_CLOSE(y(n),x(n)+Cplx(0.5,-1.)*M(n,1));
+
+    //Stacking along an extra index
+    auto B = Index(QN(),3,"B");
+    auto Q = std::vector<ITensor>{T0,P,randomITensor(QN(+1),r,s,l)};
+    auto SQ = stack(Q,B);
+    CHECK(hasQNs(SQ));
+    CHECK(order(SQ) == 4);
+    for(auto n : range(3))
+        {
+        CHECK(norm(SQ*setElt(dag(B)=n+1)-Q[n]) < 1E-14);
+        }
+    auto UQ = unstack(permute(SQ,B,s,r,l),B);
+    REQUIRE(UQ.size() == 3);
+    for(auto n : range(3)) CHECK(norm(UQ[n]-Q[n]) < 1E-14);
+    auto BD = Index(2,"B");
+    auto SD = stack({D,randomITensor(b,a)},BD);
+    CHECK(isComplex(SD));
+    auto UD = unstack(SD,BD);
+    CHECK(norm(UD[0]-D) < 1E-14);
+    CHECK_THROWS_AS(stack({D},BD),ITError);
+    }
+
+SECTION("Davidson (QN, Complex, Several Eigenvectors)")
+    {
+    const int N = 8;
+    MPO H;
+    MPS psi;
+    complexChain(N,2,H,psi);
+
+    auto PH = LocalMPO(H);
+    PH.position(N/2,psi);
+
+    auto phi = std::vector<ITensor>(3,psi(N/2)*psi(N/2+1));
+    auto eigs = davidson(PH,phi,{"MaxIter",100,"ErrGoal",1E-12});
+    CHECK(eigs[0] <= eigs[1]);
+    CHECK(eigs[1] <= eigs[2]);
+    for(auto j : range(3))
+        {
+        CHECK(hasQNs(phi[j]));
+        CHECK(isComplex(phi[j]));
+        CHECK_CLOSE(norm(phi[j]),1.);
+        ITensor Hphi;
+        PH.product(phi[j],Hphi);
+        CHECK(norm(Hphi-eigs[j]*phi[j]) < 1E-8);
+        for(auto k : range(j)) CHECK(std::abs(eltC(dag(phi[k])*phi[j])) < 1E-8);
+        }
+    }
+
+SECTION("Block Davidson")
+    {
+    auto a1 = Index(3,"Site,a1");
+    auto a2 = Index(4,"Site,a2");
+    auto a3 = Index(5,"Site,a3");
+
+    auto A = randomITensor(prime(a1),prime(a2),prime(a3),a1,a2,a3);
+    A = 0.5*(A + swapPrime(dag(A),0,1));
+    auto Amap = BatchedITensorMap(A);
+
+    auto phi0 = std::vector<ITensor>(4);
+    for(auto& p : phi0) p = randomITensor(a1,a2,a3);
+    auto phis = phi0;
+    auto eigs = davidson(Amap,phis,{"MaxIter",59,"ErrGoal",1E-14});
+    CHECK(Amap.nbatch == 0);
+    auto phib = phi0;
+    auto eigb = davidson(Amap,phib,{"MaxIter",40,"ErrGoal",1E-14,"DavidsonMethod","Block"});
+    //One batched product per block iteration
+    //(plus one for the initial vectors)
+    CHECK(Amap.nbatch > 1);
+    CHECK(Amap.nbatch <= 41);
+    for(auto j : range(4))
+        {
+        CHECK(eigb[j] == Approx(eigs[j]).epsilon(1E-10));
+        CHECK_CLOSE(norm(phib[j]),1.);
+        CHECK(norm(noPrime(A*phib[j])-eigb[j]*phib[j]) < 1E-8);
+        for(auto k : range(j)) CHECK(std::abs(elt(phib[k]*phib[j])) < 1E-8);
+        }
+
+    //QN, complex and identical initial vectors
+    const int N = 8;
+    MPO H;
+    MPS psi;
+    complexChain(N,1,H,psi);
+
+    auto PH = LocalMPO(H);
+    PH.position(N/2,psi);
+
+    auto phi = std::vector<ITensor>(3,psi(N/2)*psi(N/2+1));
+    auto ref = phi;
+    auto eref = davidson(PH,ref,{"MaxIter",100,"ErrGoal",1E-12});
+    auto eb = davidson(PH,phi,{"MaxIter",60,"ErrGoal",1E-12,"DavidsonMethod","Block"});
+    //Single-vector Davidson can miss an eigenvector
+    //with these starting vectors, block Davidson
+    //is expected to be at least as low
+    CHECK(eb[0] == Approx(eref[0]).epsilon(1E-9));
+    for(auto j : range(3))
+        {
+        CHECK(eb[j] <= eref[j]+1E-9);
+        if(j > 0) CHECK(eb[j-1] <= eb[j]);
+        CHECK(hasQNs(phi[j]));
+        CHECK(isComplex(phi[j]));
+        ITensor Hphi;
+        PH.product(phi[j],Hphi);
+        CHECK(norm(Hphi-eb[j]*phi[j]) < 1E-8);
+        for(auto k : range(j)) CHECK(std::abs(eltC(dag(phi[k])*phi[j])) < 1E-8);
+        }
+    }
+
+SECTION("Krylov Exponential (expApplyH)")
+    {
+    //exp(tau*H)*phi from exponentiating H exactly
+    auto exactExp = [](ITensor const& H, ITensor const& phi, Cplx tau)
+        {
+        auto res = expHermitian(H,tau)*phi;
+        res.replaceTags("1","0");
+        return res;
+        };
+    auto check = [&exactExp](ITensor H, ITensor const& phi)
+        {
+        H = H + swapPrime(dag(H),0,1);
+        H *= 4./norm(H);
+        for(auto tau : {Cplx(-0.5,0.),Cplx(0.,-0.5)})
+            {
+            auto psi = phi;
+            auto args = Args("MaxKrylov",40,"ErrGoal",1E-12);
+            if(tau.imag() == 0.) expApplyH(ExpITensorMap(H),psi,tau.real(),NoDir,args);
+            else                 expApplyH(ExpITensorMap(H),psi,tau,NoDir,args);
+            CHECK(not args.getBool("KrylovNoCover",false));
+            CHECK(isComplex(psi) == (tau.imag() != 0.));
+            auto ex = exactExp(H,phi,tau);
+            CHECK(norm(psi-ex) < 1E-9*norm(ex));
+            }
+        };
+
+    auto a1 = Index(6,"Site,a1");
+    auto a2 = Index(6,"Site,a2");
+    auto a3 = Index(4,"Site,a3");
+    check(randomITensor(prime(a1),prime(a2),prime(a3),a1,a2,a3),
+          randomITensor(a1,a2,a3));
+
+    auto i = Index(QN(+1),5,
+                   QN(0),6,
+                   QN(-1),5);
+    auto j = Index(QN(+1),4,
+                   QN(0),6,
+                   QN(-1),4,
+                   In);
+    auto phi = randomITensor(QN(0),dag(i),dag(j));
+    check(randomITensor(QN(0),prime(dag(i)),prime(dag(j)),i,j),phi);
+    }
+
 }
@@ -1,8 +1,10 @@
 #include "test.h"
 #include "itensor/mps/localop.h"
 #include "itensor/mps/localmpo.h"
+#include "itensor/mps/autompo.h"
 #include "itensor/mps/sites/spinhalf.h"
 #include "itensor/util/print_macro.h"
+#include "mps_mpo_test_helper.h"
 
 using namespace itensor;
 
@@ -61,6 +63,28 @@ SECTION("Product")
         CHECK(hasIndex(Hpsi,l0));
         CHECK(hasIndex(Hpsi,l2));
         }
+
+    SECTION("Batch")
+        {
+        auto Op1 = randomITensor(s1,prime(s1),h0,h1);
+        auto Op2 = randomITensor(s2,prime(s2),h1,h2);
+        auto L = randomITensor(l0,prime(l0),h0);
+        auto R = randomITensor(l2,prime(l2),h2);
+        auto lop = LocalOp(Op1,Op2,L,R);
+        auto psi = std::vector<ITensor>(3);
+        psi[0] = randomITensor(l0,s1,s2,l2);
+        psi[1] = 2.5*randomITensor(l2,s2,s1,l0);
+        psi[2] = randomITensorC(l0,s1,s2,l2);
+        auto Hpsi = std::vector<ITensor>{};
+        lop.productBatch(psi,Hpsi);
+        REQUIRE(Hpsi.size() == 3);
+        for(auto n : range(3))
+            {
+            auto Hpsin = ITensor();
+            lop.product(psi[n],Hpsin);
+            CHECK(norm(Hpsi[n]-Hpsin) < 1E-12*norm(Hpsin));
+            }
+        }
     }
 
 SECTION("Diag")
@@ -115,6 +139,86 @@ SECTION("LocalMPO As MPS")
     auto lmps = LocalMPO(psiN);
     lmps.position(3,psiF);
     }
+
+SECTION("Batched Product")
+    {
+    auto sites = SpinHalf(8,{"ConserveQNs=",true});
+    auto H = spinChainMPO(sites,Cplx(0.5,0.1));
+    auto psi = entangledNeelMPS(sites,H,1);
+    psi.position(4);
+
+    auto PH = LocalMPO(H);
+    PH.position(4,psi);
+    auto phi0 = psi(4)*psi(5);
+    auto phi = std::vector<ITensor>{phi0,random(phi0),3.*random(phi0),random(phi0)};
+    phi[1].randomize({"Complex",true});
+    auto Hphi = std::vector<ITensor>{};
+    PH.productBatch(phi,Hphi);
+    REQUIRE(Hphi.size() == phi.size());
+    for(auto n : range(phi.size()))
+        {
+        ITensor Hphin;
+        PH.product(phi[n],Hphin);
+        CHECK(hasQNs(Hphi[n]));
+        CHECK(div(Hphi[n]) == div(Hphin));
+        CHECK(norm(Hphi[n]-Hphin) < 1E-12*norm(Hphin));
+        }
+    }
+
+SECTION("Asynchronous Write To Disk")
+    {
+    auto N = 10;
+    auto sites = SpinHalf(N,{"ConserveQNs=",true});
+    auto H = spinChainMPO(sites);
+    auto psi = entangledNeelMPS(sites,H,2);
+
+    auto PH = LocalMPO(H);
+    auto PHs = LocalMPO(H);
+    PHs.doWrite(true,{"WriteAsync",false});
+    auto PHa = LocalMPO(H);
+    PHa.doWrite(true,{"WritePrefetch",2,"WriteMaxPending",3});
+
+    //Two full sweeps
+    auto bonds = std::vector<int>{};
+    for(int sw = 1; sw <= 2; ++sw)
+        {
+        for(int b = 1; b < N; ++b) bonds.push_back(b);
+        for(int b = N-2; b > 1; --b) bonds.push_back(b);
+        }
+    for(auto b : bonds)
+        {
+        PH.position(b,psi);
+        PHs.position(b,psi);
+        PHa.position(b,psi);
+        auto phi = psi(b)*psi(b+1);
+        ITensor Hphi,Hphis,Hphia;
+        PH.product(phi,Hphi);
+        PHs.product(phi,Hphis);
+        PHa.product(phi,Hphia);
+        CHECK(norm(Hphis-Hphi) < 1E-12*norm(Hphi));
+        CHECK(norm(Hphia-Hphi) < 1E-12*norm(Hphi));
+        }
+    rmTempDir(PHs.writeDir());
+    rmTempDir(PHa.writeDir());
+
+    //AsyncTensorIO on its own
+    auto dir = mkTempDir("asyncio");
+    auto io = AsyncTensorIO(2);
+    auto i = Index(4,"i");
+    auto T = randomITensor(i,prime(i));
+    io.write(dir+"/T",T);
+    ITensor R;
+    io.read(dir+"/T",R);
+    CHECK(norm(R-T) < 1E-14);
+    io.flush();
+    io.prefetch(dir+"/T");
+    io.prefetch(dir+"/missing"); //never written: ignored
+    io.read(dir+"/T",R);
+    CHECK(norm(R-T) < 1E-14);
+    //Reading a missing file throws as readFromFile does
+    CHECK_THROWS_AS(io.read(dir+"/missing",R),ITError);
+    rmTempDir(dir);
+    }
 }
 
 
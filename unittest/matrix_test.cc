@@ -1014,6 +1014,50 @@ SECTION("Test Matrix multiplication")
         }
     }
 
+SECTION("Complex Matrix Multiplication Methods")
+    {
+    auto Ar = 7,
+         K  = 5,
+         Bc = 6;
+    auto A = CMatrix(Ar,K);
+    auto B = CMatrix(Bc,K);
+    auto C0 = CMatrix(Ar,Bc);
+    for(auto& el : A) el = Cplx(Global::random(),Global::random());
+    for(auto& el : B) el = Cplx(Global::random(),Global::random());
+    for(auto& el : C0) el = Cplx(Global::random(),Global::random());
+
+    //C = 2*A*B^T + 0.5*C, with B transposed
+    auto R = C0;
+    for(auto r : range(Ar))
+    for(auto c : range(Bc))
+        {
+        Cplx val = 0;
+        for(auto k : range(K)) val += A(r,k)*B(c,k);
+        R(r,c) = 2.*val + 0.5*C0(r,c);
+        }
+
+    for(auto method : {ZGemmMethod::Native,ZGemmMethod::ThreeM,ZGemmMethod::Emulate,ZGemmMethod::Auto})
+        {
+        setZGemmMethod(method);
+        auto C = C0;
+        gemm(makeRef(A),transpose(makeRef(B)),makeRef(C),2.,0.5);
+        CHECK(norm(C-R) < 1E-12);
+        //beta == 0 must ignore the contents of C
+        for(auto& el : C) el = Cplx(NAN,NAN);
+        gemm(makeRef(A),transpose(makeRef(B)),makeRef(C),1.,0.);
+        CHECK(norm(C-(R-0.5*C0)/2.) < 1E-12);
+        }
+    setZGemmMethod(ZGemmMethod::Auto);
+
+    //Auto switches to 3M for large products
+    auto size = getZGemm3MSize();
+    setZGemm3MSize(1);
+    auto C = C0;
+    gemm(makeRef(A),transpose(makeRef(B)),makeRef(C),2.,0.5);
+    CHECK(norm(C-R) < 1E-12);
+    setZGemm3MSize(size);
+    CHECK(getZGemm3MSize() == size);
+    }
 
 SECTION("Addition / Subtraction")
     {
@@ -1567,6 +1611,90 @@ SECTION("Singular Value Decomp")
 
         CHECK(norm(M-U*D*conj(transpose(V))) < 1E-12);
         }
+
+    SECTION("LAPACK SVD Methods")
+        {
+        for(auto method : {SVDMethod::Gesdd,SVDMethod::Gesvd})
+            {
+            //Tall, wide, and square real matrices
+            for(auto dims : {std::make_pair(12,7),std::make_pair(7,12),std::make_pair(9,9)})
+                {
+                auto M = Matrix(dims.first,dims.second);
+                randomize(M);
+                Matrix U,V;
+                Vector d;
+                SVD(M,U,d,V,SVD_THRESH,method);
+                CHECK(d.size() == size_t(std::min(dims.first,dims.second)));
+                for(auto j : range1(d.size()-1)) CHECK(d(j-1) >= d(j));
+                auto D = Matrix(d.size(),d.size());
+                diagonal(D) &= d;
+                CHECK(norm(M-U*D*transpose(V)) < 1E-12);
+                auto UtU = Matrix(transpose(U)*U);
+                for(auto i : range(d.size()))
+                for(auto j : range(d.size()))
+                    {
+                    CHECK_CLOSE(UtU(i,j),(i==j ? 1. : 0.));
+                    }
+                }
+
+            auto M = CMatrix(8,11);
+            for(auto& el : M) el = Global::random() + 1_i*Global::random();
+            CMatrix U,V;
+            Vector d;
+            SVD(M,U,d,V,SVD_THRESH,method);
+            auto D = Matrix(d.size(),d.size());
+            diagonal(D) &= d;
+            CHECK(norm(M-U*D*conj(transpose(V))) < 1E-12);
+            }
+        CHECK(toSVDMethod("gesdd") == SVDMethod::Gesdd);
+        CHECK_THROWS_AS(toSVDMethod("qr"),std::runtime_error);
+        }
+
+    SECTION("Randomized SVD")
+        {
+        //Matrix with quickly decaying singular values
+        auto nr = 60,
+             nc = 40;
+        auto R = Matrix(nr,nc);
+        randomize(R);
+        Matrix Q1,Q2;
+        Vector s;
+        SVD(R,Q1,s,Q2);
+        for(auto j : range(s.size())) s(j) = std::pow(0.5,j);
+        auto S = Matrix(s.size(),s.size());
+        diagonal(S) &= s;
+        auto M = Matrix(Q1*S*transpose(Q2));
+
+        for(auto method : {SVDMethod::Recursive,SVDMethod::Gesdd})
+            {
+            auto k = 12;
+            auto U = Matrix(nr,k),
+                 V = Matrix(nc,k);
+            auto d = Vector(k);
+            randomizedSVDRef(makeRef(M),makeRef(U),makeRef(d),makeRef(V),2,method);
+            for(auto j : range(6)) CHECK(std::abs(d(j)-s(j)) < 1E-10);
+            auto UtU = Matrix(transpose(U)*U);
+            for(auto i : range(k))
+            for(auto j : range(k))
+                {
+                CHECK_CLOSE(UtU(i,j),(i==j ? 1. : 0.));
+                }
+            auto D = Matrix(k,k);
+            diagonal(D) &= d;
+            CHECK(norm(M-U*D*transpose(V)) < 1E-3);
+            }
+
+        auto C = CMatrix(30,20);
+        for(auto& el : C) el = Global::random() + 1_i*Global::random();
+        auto U = CMatrix(30,20),
+             V = CMatrix(20,20);
+        auto d = Vector(20);
+        //Full rank: exact up to round-off
+        randomizedSVDRef(makeRef(C),makeRef(U),makeRef(d),makeRef(V),1,SVDMethod::Gesdd);
+        auto D = Matrix(20,20);
+        diagonal(D) &= d;
+        CHECK(norm(C-U*D*conj(transpose(V))) < 1E-10);
+        }
     }
 
 //SECTION("Complex SVD")
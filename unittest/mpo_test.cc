@@ -163,6 +163,110 @@ SECTION("applyMPO (DensityMatrix)")
     CHECK(checkTags(Hpsi,"Site,1","Link,0"));
 
     CHECK_CLOSE(errorMPOProd(Hpsi,H,psi),0.0);
+
+    //Checkpointed environments, recomputed
+    //(and read back from disk) when needed
+    auto Hpsi_mm = applyMPO(H,psi,{"Method=",method,"Cutoff=",1E-13,"MaxDim=",200,"MaxMemory=",1E-3});
+    CHECK(checkTags(Hpsi_mm,"Site,1","Link,0"));
+    CHECK(norm(sum(Hpsi_mm,-1*Hpsi)) < 1E-10);
+
+    //Checkpointed environments kept in memory:
+    //MaxMemory is set between the size of the checkpoints
+    //plus the longest recomputed segment and the size of
+    //the full set (every environment is dim(psi link)^2
+    //times dim(MPO link)^2 complex numbers without QNs)
+    auto nqsites = SpinHalf(N,{"ConserveQNs=",false});
+    auto Hnq = randomUnitaryMPO(nqsites);
+    auto phi = entangledNeelMPS(nqsites,randomUnitaryMPO(nqsites),2);
+    auto Hphi = applyMPO(Hnq,phi,{"Method=",method,"Cutoff=",1E-13,"MaxDim=",200});
+    auto stride = int(std::ceil(std::sqrt(double(N-1))));
+    auto total = 0.,
+         ckpt = 0.,
+         seg = 0.,
+         maxseg = 0.;
+    for(auto j : range1(N-1))
+        {
+        auto d = double(dim(linkIndex(phi,j)))*dim(linkIndex(Hnq,j));
+        auto bytes = sizeof(Cplx)*d*d;
+        total += bytes;
+        if((j-1)%stride == 0)
+            {
+            ckpt += bytes;
+            seg = 0.;
+            }
+        else
+            {
+            seg += bytes;
+            maxseg = std::max(maxseg,seg);
+            }
+        }
+    REQUIRE(ckpt+maxseg < total);
+    auto maxmem = 0.5*(ckpt+maxseg+total)/1E6;
+    auto Hphi_mm = applyMPO(Hnq,phi,{"Method=",method,"Cutoff=",1E-13,"MaxDim=",200,"MaxMemory=",maxmem});
+    CHECK(checkTags(Hphi_mm,"Site,1","Link,0"));
+    CHECK(norm(sum(Hphi_mm,-1*Hphi)) < 1E-10*norm(Hphi));
+    }
+
+SECTION("applyMPO (ZipUp)")
+    {
+    auto method = "ZipUp";
+
+    auto N = 20;
+    auto sites = SpinHalf(N);
+    auto initstate = InitState(sites,"Up");
+    for( auto j : range1(N) ) if( j%2 == 1 )
+      initstate.set(j,"Dn");
+
+    auto psi = randomMPS(initstate,{"Complex=",true});
+
+    auto H = randomUnitaryMPO(sites);
+    auto K = randomUnitaryMPO(sites);
+
+    // Apply K to psi to entangle psi
+    psi = applyMPO(K,psi,{"Method=",method,"Cutoff=",0.,"MaxDim=",200});
+    CHECK(checkTags(psi,"Site,1","Link,0"));
+    psi.noPrime("Site");
+    CHECK(checkTags(psi));
+    CHECK(isOrtho(psi));
+    CHECK(orthoCenter(psi) == 1);
+
+    auto Hpsi = applyMPO(H,psi,{"Method=",method,"Cutoff=",1E-13,"MaxDim=",200});
+    CHECK(checkTags(Hpsi,"Site,1","Link,0"));
+    CHECK_CLOSE(errorMPOProd(Hpsi,H,psi),0.0);
+
+    auto Hpsi_dm = applyMPO(H,psi,{"Method=","DensityMatrix","Cutoff=",1E-13,"MaxDim=",200});
+    CHECK(std::abs(innerC(Hpsi,Hpsi_dm)) == Approx(norm(Hpsi)*norm(Hpsi_dm)).epsilon(1E-10));
+
+    // Fit starts from the zip-up result,
+    // so a single sweep is enough
+    auto Hpsi_f = applyMPO(H,psi,{"Method=","Fit","Cutoff=",1E-13,"MaxDim=",200,"Nsweep=",1});
+    CHECK_CLOSE(errorMPOProd(Hpsi_f,H,psi),0.0);
+
+    // Truncated (to few enough states that the error
+    // is well above the one set by the cutoff)
+    auto maxdim = 2;
+    auto Hpsi_t = applyMPO(H,psi,{"Method=",method,"Cutoff=",1E-13,"MaxDim=",maxdim});
+    CHECK(maxLinkDim(Hpsi_t) <= maxdim);
+    auto Hpsi_tdm = applyMPO(H,psi,{"Method=","DensityMatrix","Cutoff=",1E-13,"MaxDim=",maxdim});
+    CHECK(errorMPOProd(Hpsi_t,H,psi) < 2*errorMPOProd(Hpsi_tdm,H,psi));
+
+    // Single site
+    auto s1 = Index(2,"Site,n=1");
+    auto K1 = MPO(1);
+    K1.ref(1) = randomITensor(dag(s1),prime(s1));
+    auto psi1 = MPS(1);
+    psi1.ref(1) = randomITensor(s1);
+    auto Kpsi1 = applyMPO(K1,psi1,{"Method=",method});
+    auto exact1 = K1(1)*psi1(1);
+    CHECK(norm(Kpsi1(1)-exact1) < 1E-12*norm(exact1));
+
+    // With QNs
+    auto qsites = SpinHalf(N,{"ConserveQNs=",true});
+    auto HQ = spinChainMPO(qsites);
+    auto phi = entangledNeelMPS(qsites,HQ,2,{"Method=",method,"Cutoff=",1E-13});
+    auto HQphi = applyMPO(HQ,phi,{"Method=",method,"Cutoff=",1E-13});
+    CHECK(hasQNs(HQphi));
+    CHECK_CLOSE(errorMPOProd(HQphi,HQ,phi),0.0);
     }
 
 SECTION("applyMPO (DensityMatrix) with custom tags")
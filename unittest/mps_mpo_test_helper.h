@@ -53,6 +53,48 @@ diff(MPS const& psi, MPS const& phi)
   return std::sqrt(std::abs(norm_psi/norm_phi+1.-2.*real(psi_phi)/norm_phi));
   }
 
+//
+// Spin-half chain with couplings
+// c*S+_j S-_{j+1} + conj(c)*S-_j S+_{j+1} + Sz_j Sz_{j+1}
+// (c = 0.5 is the Heisenberg chain)
+//
+MPO inline
+spinChainMPO(SiteSet const& sites, Cplx c = 0.5)
+  {
+  auto N = length(sites);
+  auto ampo = AutoMPO(sites);
+  for(auto j : range1(N-1))
+      {
+      ampo += c,"S+",j,"S-",j+1;
+      ampo += std::conj(c),"S-",j,"S+",j+1;
+      ampo +=     "Sz",j,"Sz",j+1;
+      }
+  return toMPO(ampo);
+  }
+
+//
+// Random MPS with Neel state quantum numbers, given
+// some entanglement by napply (normalized) applications
+// of H using applyMPO with args
+//
+MPS inline
+entangledNeelMPS(SiteSet const& sites,
+                 MPO const& H,
+                 int napply,
+                 Args const& args = Args("Cutoff",1E-12))
+  {
+  auto state = InitState(sites);
+  for(auto j : range1(length(sites))) state.set(j,j%2 == 1 ? "Up" : "Dn");
+  auto psi = randomMPS(state);
+  for(int n = 0; n < napply; ++n)
+      {
+      psi = applyMPO(H,psi,args);
+      psi.noPrime("Site");
+      psi.normalize();
+      }
+  return psi;
+  }
+
 MPO inline
 randomUnitaryMPO(SiteSet const& sites, Args const& args = Args::global())
   {
@@ -263,6 +263,30 @@ SECTION("PositionTest")
     CHECK_EQUAL(findCenter(psi),4);
     }
 
+SECTION("Copy With doWrite")
+    {
+    auto psi = randomMPS(shsites);
+    auto orig = psi;
+    psi.doWrite(true);
+    //Move the loaded bond to the right end and back
+    //so that every site tensor is written
+    for(auto j : range1(N)) psi(j);
+    psi(1);
+
+    auto cpsi = psi;
+    CHECK(cpsi.doWrite());
+    //Changing psi does not change its copy,
+    //even though they started out sharing files
+    psi.ref(4) *= 2.;
+    for(auto j : range1(N)) psi(j);
+    psi(1);
+    for(auto j : range1(N))
+        {
+        CHECK(norm(cpsi(j)-orig(j)) < 1E-12);
+        }
+    CHECK(norm(psi(4)-2.*orig(4)) < 1E-12);
+    }
+
 SECTION("Orthogonalize")
     {
     auto d = 20;
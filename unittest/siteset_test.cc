@@ -5,6 +5,7 @@
 #include "itensor/mps/sites/electron.h"
 #include "itensor/mps/sites/fermion.h"
 #include "itensor/mps/sites/tj.h"
+#include "itensor/mps/sites/boson.h"
 #include "itensor/util/print_macro.h"
 #include "itensor/util/str.h"
 
@@ -161,5 +162,42 @@ SECTION("tJ")
     op(sites,"Adn",2); 
     op(sites,"F",2); 
     }
-}
 
+SECTION("Operator Cache")
+    {
+    auto sites = Boson(N,{"MaxOcc=",4,"ConserveQNs=",true});
+    sites.clearOpCache();
+    for(auto i : range1(N))
+        {
+        auto Op = sites.op("Adag",i);
+        CHECK(hasIndex(Op,sites(i)));
+        CHECK(hasIndex(Op,prime(sites(i))));
+        CHECK(norm(Op-BosonSite(sites(i)).op("Adag",{})) < 1E-14);
+        }
+    //Made once, for site 1
+    CHECK(sites.opCacheStats().misses == 1);
+    CHECK(sites.opCacheStats().hits == N-1);
+
+    auto NN = sites.op("N*N",3);
+    CHECK(norm(NN-multSiteOps(sites.op("N",3),sites.op("N",3))) < 1E-14);
+
+    //Changing a returned operator does not
+    //change the cached one
+    auto A = sites.op("A",2);
+    A *= 2.;
+    A.set(2,1,7.);
+    CHECK(norm(sites.op("A",2)-BosonSite(sites(2)).op("A",{})) < 1E-14);
+
+    //Args are part of the key
+    auto P1 = sites.op("Proj",4,{"State=",1});
+    auto P2 = sites.op("Proj",4,{"State=",2});
+    CHECK(elt(P1,dag(sites(4))=1,prime(sites(4))=1) == 1.);
+    CHECK(elt(P2,dag(sites(4))=1,prime(sites(4))=1) == 0.);
+
+    //Sites of different types or dimensions
+    auto s1 = SpinOne(N,{"SHalfEdge=",true});
+    CHECK(dim(inds(s1.op("Sz",1))(1)) == 2);
+    CHECK(dim(inds(s1.op("Sz",2))(1)) == 3);
+    CHECK(dim(inds(s1.op("Sz",N))(1)) == 2);
+    }
+}
@@ -4,6 +4,7 @@
 #include "itensor/detail/algs.h"
 #include "itensor/tensor/permutation.h"
 #include "itensor/tensor/sliceten.h"
+#include "itensor/util/threadpool.h"
 #include "itensor/indexset.h"
 
 using namespace itensor;
@@ -444,5 +445,65 @@ SECTION("Slicing")
             }
         }
 
+    SECTION("Permute Kernel")
+        {
+        //Tile remainders, extent-1 indices, and
+        //indices which can be merged
+        auto check = [](Tensor T, std::vector<Labels> const& perms)
+            {
+            for(auto& el : T) el = detail::quickran();
+            for(auto const& P : perms)
+                {
+                auto V = permute(T,P);
+                auto C = Tensor(V);
+                for(auto& i : C.range())
+                    {
+                    CHECK(C(i) == V(i));
+                    }
+                auto D = Tensor(V);
+                makeRef(D) += V;
+                for(auto& i : D.range())
+                    {
+                    CHECK_CLOSE(D(i),2*V(i));
+                    }
+                }
+            };
+        auto shapes = [&check]()
+            {
+            check(Tensor(33,65),{{0,1},{1,0}});
+            check(Tensor(70,3,45),{{0,2,1},{1,0,2},{1,2,0},{2,0,1},{2,1,0}});
+            check(Tensor(40,2,3,37),{{3,1,2,0},{0,2,1,3},{2,3,0,1},{1,0,3,2}});
+            check(Tensor(1,50,1,40),{{0,3,2,1},{3,1,2,0}});
+            };
+
+        SECTION("Serial")
+            {
+            shapes();
+            }
+
+        SECTION("Threaded")
+            {
+            auto size = getPermuteParallelSize();
+            auto nthread = getNThread();
+            setPermuteParallelSize(0);
+            setNThread(3);
+            shapes();
+            setNThread(nthread);
+            setPermuteParallelSize(size);
+            }
+
+        SECTION("Complex")
+            {
+            auto T = CTensor(35,4,50);
+            for(auto& el : T) el = Cplx(detail::quickran(),detail::quickran());
+            auto V = permute(T,Labels{2,1,0});
+            auto C = CTensor(V);
+            for(auto& i : C.range())
+                {
+                CHECK(C(i) == V(i));
+                }
+            }
+        }
+
     } // Slicing
 }
@@ -3,6 +3,9 @@
 #include "itensor/global.h"
 #include "itensor/util/infarray.h"
 #include "itensor/util/stats.h"
+#include "itensor/util/threadpool.h"
+#include "itensor/util/scratch.h"
+#include "itensor/itensor.h"
 
 using namespace itensor;
 using namespace std;
@@ -261,3 +264,156 @@ SECTION("BinErr")
     }
 }
 
+
+TEST_CASE("ThreadPool")
+{
+auto pool = ThreadPool(4);
+
+SECTION("Run")
+    {
+    auto N = 100;
+    auto res = std::vector<long>(N,0);
+    auto tasks = std::vector<ThreadPool::Task>{};
+    for(auto n : range(N)) tasks.emplace_back([n,&res]() { res[n] = n*n; });
+    pool.run(tasks);
+    for(auto n : range(N)) CHECK(res[n] == n*n);
+    }
+
+SECTION("Cost Weighted")
+    {
+    auto N = 50;
+    auto res = std::vector<long>(N,0);
+    auto tasks = std::vector<ThreadPool::Task>{};
+    auto costs = std::vector<double>{};
+    for(auto n : range(N)) 
+        {
+        tasks.emplace_back([n,&res]() { res[n] = n+1; });
+        costs.push_back((n%7)*1000.);
+        }
+    pool.run(tasks,costs);
+    for(auto n : range(N)) CHECK(res[n] == n+1);
+    }
+
+SECTION("Nested")
+    {
+    auto res = std::vector<long>(16,0);
+    auto outer = std::vector<ThreadPool::Task>{};
+    for(auto i : range(4))
+        {
+        outer.emplace_back([i,&res,&pool]()
+            {
+            auto inner = std::vector<ThreadPool::Task>{};
+            for(auto j : range(4)) inner.emplace_back([i,j,&res]() { res[4*i+j] = 1; });
+            pool.run(inner);
+            });
+        }
+    pool.run(outer);
+    for(auto r : res) CHECK(r == 1);
+    }
+
+SECTION("Parallel For")
+    {
+    auto N = 30;
+    auto costs = std::vector<double>(N);
+    for(auto n : range(N)) costs[n] = (n*13)%17;
+    for(auto maxthread : {1,2,4})
+        {
+        auto res = std::vector<long>(N,0);
+        parallelFor(pool,costs,maxthread,[&res](size_t n) { res[n] += long(n)+1; });
+        for(auto n : range(N)) CHECK(res[n] == n+1);
+        }
+    }
+
+SECTION("Exception")
+    {
+    auto tasks = std::vector<ThreadPool::Task>{};
+    for(auto n : range(8)) 
+        {
+        tasks.emplace_back([n]() { if(n == 5) throw std::runtime_error("task failed"); });
+        }
+    CHECK_THROWS_AS(pool.run(tasks),std::runtime_error);
+    }
+}
+
+TEST_CASE("ScratchBuffer")
+{
+clearScratch();
+resetScratchStats();
+
+SECTION("Reuse")
+    {
+        {
+        auto b = ScratchBuffer<Real>(1000,true);
+        CHECK(b.size() == 1000);
+        for(auto n : range(b.size())) CHECK(b[n] == 0.);
+        CHECK(scratchStats().bytes_in_use >= 1000*sizeof(Real));
+        }
+    CHECK(scratchStats().bytes_in_use == 0);
+    //Same size class: block is reused
+        {
+        auto b = ScratchBuffer<Real>(900);
+        }
+    auto s = scratchStats();
+    CHECK(s.requests == 2);
+    CHECK(s.allocations == 1);
+    CHECK(s.peak_bytes >= 1000*sizeof(Real));
+    CHECK(s.bytes_cached >= 1000*sizeof(Real));
+    clearScratch();
+    CHECK(scratchStats().bytes_cached == 0);
+    }
+
+SECTION("Nested and Moved")
+    {
+    auto b1 = ScratchBuffer<Cplx>(10);
+    auto b2 = ScratchBuffer<Cplx>(10);
+    CHECK(b1.data() != b2.data());
+    auto p = b2.data();
+    auto b3 = std::move(b2);
+    CHECK(b3.data() == p);
+    CHECK(b2.data() == nullptr);
+    CHECK(scratchStats().bytes_in_use >= 20*sizeof(Cplx));
+    b1.reset();
+    b3.reset();
+    CHECK(scratchStats().bytes_in_use == 0);
+    }
+
+SECTION("Size Classes and Limits")
+    {
+    //At most 25% rounding up
+        {
+        auto b = ScratchBuffer<char>(1025);
+        CHECK(scratchStats().bytes_in_use == 1280);
+        }
+    //Large blocks are exact and not cached
+        {
+        auto b = ScratchBuffer<char>(ScratchArena::LargeBytes+1);
+        CHECK(scratchStats().bytes_in_use == ScratchArena::LargeBytes+1);
+        }
+    CHECK(scratchStats().bytes_cached == 1280);
+    //More blocks than the cache may hold
+        {
+        auto bufs = std::vector<ScratchBuffer<char>>{};
+        for(int n = 0; n < 8; ++n) bufs.emplace_back(ScratchArena::LargeBytes/2);
+        }
+    CHECK(scratchArena().cachedBytes() <= ScratchArena::MaxCachedBytes);
+    CHECK(scratchStats().bytes_cached == scratchArena().cachedBytes());
+    clearScratch();
+    }
+
+SECTION("Large Contraction")
+    {
+    auto i = Index(200),
+         j = Index(200),
+         k = Index(300),
+         l = Index(20);
+    auto A = randomITensor(i,j,k);
+    auto B = randomITensor(l,j);
+    auto C = A*B;
+    CHECK(order(C) == 3);
+    auto s = scratchStats();
+    CHECK(s.bytes_in_use == 0);
+    CHECK(s.bytes_cached <= getNThread()*ScratchArena::MaxCachedBytes);
+    CHECK(scratchArena().cachedBytes() <= ScratchArena::MaxCachedBytes);
+    clearScratch();
+    }
+}